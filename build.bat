@@ -7,7 +7,7 @@ set INCLUDE=-Ivendor/raylib-5.0/include
 set LIB=-Lvendor/raylib-5.0/lib
 
 set LINK=^
-    -lraylib -lgdi32 -lwinmm
+    -lraylib -lgdi32 -lwinmm -lpthread
 
 set SRC_DIR=src
 set TARGET_DIR=target
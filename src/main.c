@@ -2,10 +2,35 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <float.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CURVEMAKER_X86
+#include <immintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
 
 #include "raylib.h"
 #include "raymath.h"
 
+#include "shared_curves.h"
+
 typedef struct {
     union {
         float c[4];
@@ -59,6 +84,7 @@ void print_mat4(Mat4 m) {
     printf(" ----------------------------------------------\n");
 }
 
+// y = a*u^3 + b*u^2 + c*u + d, with u = x - x of the curve's first point
 typedef struct {
     float a, b, c, d;
 } CubicCurve;
@@ -90,11 +116,15 @@ float Vector2Slope(Vector2 vec) {
 void solve_cubic_curve(ControlPoint p1, ControlPoint p2, CubicCurve* curve) {
     const int DIM = 4;
 
+    // solved relative to p1, otherwise x^3 of far away points eats the float precision
+    float x1 = 0;
+    float x2 = p2.coord.x - p1.coord.x;
+
     Mat4 A = {
-        .r0 = {f_cube(p1.coord.x), f_sq(p1.coord.x), p1.coord.x, 1},
-        .r1 = {f_cube(p2.coord.x), f_sq(p2.coord.x), p2.coord.x, 1},
-        .r2 = {3 * f_sq(p1.coord.x), 2 * p1.coord.x, 1, 0},
-        .r3 = {3 * f_sq(p2.coord.x), 2 * p2.coord.x, 1, 0},
+        .r0 = {f_cube(x1), f_sq(x1), x1, 1},
+        .r1 = {f_cube(x2), f_sq(x2), x2, 1},
+        .r2 = {3 * f_sq(x1), 2 * x1, 1, 0},
+        .r3 = {3 * f_sq(x2), 2 * x2, 1, 0},
     };
     Vec4 b = {p1.coord.y, p2.coord.y, Vector2Slope(p1.tangent), Vector2Slope(p2.tangent)};
 
@@ -231,14 +261,231 @@ void ui_canvas_draw(UICanvas* canvas) {
     }
 }
 
+// -- Input --
+// Everything the editor reads from the mouse and keyboard in a frame goes
+// through an InputFrame, polled once at the start of the frame. Frames can
+// be recorded to a log and replayed later, headless and at full speed, to
+// get the same edits again (see --record, --replay).
+
+int64_t time_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+typedef enum {
+    INPUT_MOUSE_LEFT = 1 << 0,
+    INPUT_MOUSE_RIGHT = 1 << 1,
+    INPUT_KEY_CONTROL = 1 << 2,
+    INPUT_KEY_SHIFT = 1 << 3,
+    INPUT_KEY_Z = 1 << 4,
+    INPUT_KEY_Y = 1 << 5,
+} InputButton;
+
+typedef struct {
+    Vector2 mouse;
+    Vector2 mouse_delta;    // from the previous frame's mouse
+    float wheel;
+    uint8_t down;           // InputButton bits
+    uint8_t pressed;        // went down this frame, keys also when they repeat
+    uint8_t released;
+    int64_t time_ns;        // when the frame was polled, not recorded
+} InputFrame;
+
+bool input_down(const InputFrame* input, InputButton button) {
+    return (input->down & button) != 0;
+}
+
+bool input_pressed(const InputFrame* input, InputButton button) {
+    return (input->pressed & button) != 0;
+}
+
+bool input_released(const InputFrame* input, InputButton button) {
+    return (input->released & button) != 0;
+}
+
+InputFrame input_frame_poll(const InputFrame* previous) {
+    InputFrame input = {0};
+    input.mouse = GetMousePosition();
+    input.mouse_delta = Vector2Subtract(input.mouse, previous->mouse);
+    input.wheel = GetMouseWheelMove();
+
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) input.down |= INPUT_MOUSE_LEFT;
+    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) input.down |= INPUT_MOUSE_RIGHT;
+    if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) input.down |= INPUT_KEY_CONTROL;
+    if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) input.down |= INPUT_KEY_SHIFT;
+    if (IsKeyDown(KEY_Z)) input.down |= INPUT_KEY_Z;
+    if (IsKeyDown(KEY_Y)) input.down |= INPUT_KEY_Y;
+
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) input.pressed |= INPUT_MOUSE_LEFT;
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) input.pressed |= INPUT_MOUSE_RIGHT;
+    if (IsKeyPressed(KEY_Z) || IsKeyPressedRepeat(KEY_Z)) input.pressed |= INPUT_KEY_Z;
+    if (IsKeyPressed(KEY_Y) || IsKeyPressedRepeat(KEY_Y)) input.pressed |= INPUT_KEY_Y;
+
+    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) input.released |= INPUT_MOUSE_LEFT;
+    if (IsMouseButtonReleased(MOUSE_BUTTON_RIGHT)) input.released |= INPUT_MOUSE_RIGHT;
+
+    input.time_ns = time_now_ns();
+    return input;
+}
+
+// Log: a header, then one record per frame. A record is a byte of
+// INPUT_LOG_* bits saying which fields changed from the previous frame,
+// followed by only those fields in bit order, so an idle frame is one byte
+// and a drag frame nine. Native byte order, logs are for replaying on the
+// machine (or kind of machine) they were recorded on.
+
+#define INPUT_LOG_MAGIC 0x4c494d43 // "CMIL"
+#define INPUT_LOG_VERSION 1
+
+#define INPUT_LOG_MOUSE 0x01    // float x, y
+#define INPUT_LOG_WHEEL 0x02    // float
+#define INPUT_LOG_DOWN 0x04     // uint8_t
+#define INPUT_LOG_PRESSED 0x08  // uint8_t
+#define INPUT_LOG_RELEASED 0x10 // uint8_t
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t screen_width;  // canvases are laid out from the screen size, replays need the same
+    uint32_t screen_height;
+} InputLogHeader;
+
+typedef struct {
+    FILE* file;
+    InputLogHeader header;
+    InputFrame last;        // records are relative to it
+    unsigned long long n_frames;
+} InputLog;
+
+InputLog* input_log_create(const char* path, uint32_t screen_width, uint32_t screen_height) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Input Log: cannot create %s\n", path);
+        return NULL;
+    }
+    InputLog* log = calloc(1, sizeof(InputLog));
+    log->file = file;
+    log->header = (InputLogHeader) {
+        .magic = INPUT_LOG_MAGIC,
+        .version = INPUT_LOG_VERSION,
+        .screen_width = screen_width,
+        .screen_height = screen_height,
+    };
+    fwrite(&log->header, sizeof(InputLogHeader), 1, file);
+    return log;
+}
+
+InputLog* input_log_open(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Input Log: cannot open %s\n", path);
+        return NULL;
+    }
+    InputLogHeader header;
+    if (fread(&header, sizeof(InputLogHeader), 1, file) != 1
+        || header.magic != INPUT_LOG_MAGIC || header.version != INPUT_LOG_VERSION
+    ) {
+        printf("Input Log: %s is not an input log of version %d\n", path, INPUT_LOG_VERSION);
+        fclose(file);
+        return NULL;
+    }
+    InputLog* log = calloc(1, sizeof(InputLog));
+    log->file = file;
+    log->header = header;
+    return log;
+}
+
+void input_log_close(InputLog* log) {
+    fclose(log->file);
+    free(log);
+}
+
+void input_log_write(InputLog* log, const InputFrame* input) {
+    InputFrame* last = &log->last;
+    uint8_t record[1 + 2*sizeof(float) + sizeof(float) + 3];
+    int size = 1;
+
+    uint8_t changed = 0;
+    if (!Vector2Equals(input->mouse, last->mouse)) {
+        changed |= INPUT_LOG_MOUSE;
+        memcpy(&record[size], &input->mouse, 2*sizeof(float));
+        size += 2*sizeof(float);
+    }
+    if (input->wheel != last->wheel) {
+        changed |= INPUT_LOG_WHEEL;
+        memcpy(&record[size], &input->wheel, sizeof(float));
+        size += sizeof(float);
+    }
+    if (input->down != last->down) {
+        changed |= INPUT_LOG_DOWN;
+        record[size++] = input->down;
+    }
+    if (input->pressed != last->pressed) {
+        changed |= INPUT_LOG_PRESSED;
+        record[size++] = input->pressed;
+    }
+    if (input->released != last->released) {
+        changed |= INPUT_LOG_RELEASED;
+        record[size++] = input->released;
+    }
+    record[0] = changed;
+
+    fwrite(record, size, 1, log->file);
+    *last = *input;
+    log->n_frames++;
+}
+
+// false at the end of the log
+bool input_log_read(InputLog* log, InputFrame* input) {
+    InputFrame* last = &log->last;
+    int changed = fgetc(log->file);
+    if (changed == EOF) {
+        return false;
+    }
+
+    *input = *last;
+    bool complete = true;
+    if (changed & INPUT_LOG_MOUSE) complete &= fread(&input->mouse, 2*sizeof(float), 1, log->file) == 1;
+    if (changed & INPUT_LOG_WHEEL) complete &= fread(&input->wheel, sizeof(float), 1, log->file) == 1;
+    if (changed & INPUT_LOG_DOWN) complete &= fread(&input->down, 1, 1, log->file) == 1;
+    if (changed & INPUT_LOG_PRESSED) complete &= fread(&input->pressed, 1, 1, log->file) == 1;
+    if (changed & INPUT_LOG_RELEASED) complete &= fread(&input->released, 1, 1, log->file) == 1;
+    if (!complete) {
+        printf("Input Log: truncated after %llu frames\n", log->n_frames);
+        return false;
+    }
+    input->mouse_delta = Vector2Subtract(input->mouse, last->mouse);
+    input->time_ns = time_now_ns();
+
+    *last = *input;
+    log->n_frames++;
+    return true;
+}
+
+const float VIEW_ZOOM_MIN = 0.25;
+const float VIEW_ZOOM_MAX = 1000;
+const float VIEW_ZOOM_STEP = 1.25; // zoom multiplier per mouse wheel notch
+
 typedef struct {
     UICanvas canvas;
     // Vector2 axis_margin;
     // Vector2 axis_len;
     Vector2 axis_len; // axis_divide;
     Color axis_color;
+    // -- View --
+    Camera2D camera;        // pan/zoom inside the canvas, screen -> world
+    bool view_drag;
 } Graph2DCanvas;
 
+// part of the graph that is visible through the canvas camera
+typedef struct {
+    float x_min;            // in local coordinates
+    float x_max;
+    float zoom;             // camera zoom, divide screen sizes by it to draw them in world
+    float pixels_per_unit;  // screen pixels per local unit
+} GraphView;
+
 Graph2DCanvas graph2d_canvas_create_default(int id, Rectangle rect) {
     Vector2 axis_margin_global = {
         .x = rect.width/10.0,
@@ -275,6 +522,14 @@ Graph2DCanvas graph2d_canvas_create_default(int id, Rectangle rect) {
         // .axis_len = axis_len,
         .axis_len = axis_len_local,
         .axis_color = BLACK,
+        // -- View --
+        .camera = (Camera2D) {
+            .offset = {0, 0},
+            .target = {0, 0},
+            .rotation = 0,
+            .zoom = 1.0,
+        },
+        .view_drag = false,
     };
 }
 
@@ -299,20 +554,82 @@ void graph2d_canvas_set_rect(Graph2DCanvas* graph2d_canvas, Rectangle rect) {
     graph2d_canvas->axis_len = axis_len_local;
 }
 
-void graph2d_canvas_draw(Graph2DCanvas* graph_canvas) {
+// screen pixels -> local units, through both the camera zoom and the axis scale
+float graph2d_canvas_scale_into(Graph2DCanvas* graph2d_canvas, float f) {
+    return axis2d_scale_into(graph2d_canvas->canvas.axis, f / graph2d_canvas->camera.zoom);
+}
+
+GraphView graph2d_canvas_get_view(Graph2DCanvas* graph2d_canvas) {
+    Rectangle rect = graph2d_canvas->canvas.rect;
+    Axis2D axis = graph2d_canvas->canvas.axis;
+    Camera2D camera = graph2d_canvas->camera;
+
+    // canvas rect is in screen coordinates, take its corners through the camera and then into the axis
+    Vector2 top_left = GetScreenToWorld2D((Vector2) {rect.x, rect.y}, camera);
+    Vector2 bottom_right = GetScreenToWorld2D((Vector2) {rect.x + rect.width, rect.y + rect.height}, camera);
+    top_left = axis2d_shift_into(axis, top_left);
+    bottom_right = axis2d_shift_into(axis, bottom_right);
+
+    return (GraphView) {
+        .x_min = fminf(top_left.x, bottom_right.x),
+        .x_max = fmaxf(top_left.x, bottom_right.x),
+        .zoom = camera.zoom,
+        .pixels_per_unit = axis2d_scale_out(axis, camera.zoom),
+    };
+}
+
+void graph2d_canvas_process_view_input(Graph2DCanvas* graph2d_canvas, const InputFrame* input) {
+    Camera2D* camera = &graph2d_canvas->camera;
+    Vector2 mouse = input->mouse;
+    bool mouse_in_canvas = CheckCollisionPointRec(mouse, graph2d_canvas->canvas.rect);
+
+    // pan: drag with right button, keeps panning if the mouse leaves the canvas mid drag
+    if (mouse_in_canvas && input_pressed(input, INPUT_MOUSE_RIGHT)) {
+        graph2d_canvas->view_drag = true;
+    }
+    else if (input_released(input, INPUT_MOUSE_RIGHT)) {
+        graph2d_canvas->view_drag = false;
+    }
+
+    if (graph2d_canvas->view_drag) {
+        Vector2 delta = Vector2Scale(input->mouse_delta, -1.0/camera->zoom);
+        camera->target = Vector2Add(camera->target, delta);
+    }
+
+    // zoom: mouse wheel, around the cursor so the world point under it stays in place
+    float wheel = input->wheel;
+    if (mouse_in_canvas && wheel != 0) {
+        camera->target = GetScreenToWorld2D(mouse, *camera);
+        camera->offset = mouse;
+        camera->zoom = Clamp(camera->zoom * powf(VIEW_ZOOM_STEP, wheel), VIEW_ZOOM_MIN, VIEW_ZOOM_MAX);
+    }
+}
+
+void graph2d_canvas_begin_draw(Graph2DCanvas* graph_canvas) {
     // Draw Canvas
     ui_canvas_draw(&graph_canvas->canvas);
 
+    // everything until graph2d_canvas_end_draw is clipped to the canvas and seen through its camera
+    Rectangle rect = graph_canvas->canvas.rect;
+    BeginScissorMode(rect.x, rect.y, rect.width, rect.height);
+    BeginMode2D(graph_canvas->camera);
+
     // Draw Axis
     // canvas.axis.origin is shifted onto graph origin
     Vector2 x_axis_end = { graph_canvas->axis_len.x, 0 };
     Vector2 y_axis_end = { 0, graph_canvas->axis_len.y };
+    float axis_thick = 5 / graph_canvas->camera.zoom;
 
     Vector2 zero = axis2d_shift_out(graph_canvas->canvas.axis, Vector2Zero());
     x_axis_end = axis2d_shift_out(graph_canvas->canvas.axis, x_axis_end);
     y_axis_end = axis2d_shift_out(graph_canvas->canvas.axis, y_axis_end);
-    DrawLineEx(zero, x_axis_end, 5, graph_canvas->axis_color);
-    DrawLineEx(zero, y_axis_end, 5, graph_canvas->axis_color);
+    DrawLineEx(zero, x_axis_end, axis_thick, graph_canvas->axis_color);
+    DrawLineEx(zero, y_axis_end, axis_thick, graph_canvas->axis_color);
+}
+
+void graph2d_canvas_end_draw() {
+    EndMode2D();
+    EndScissorMode();
 }
 
 struct Global {
@@ -405,21 +722,35 @@ Spline new_init_spline() {
     return s;
 }
 
+void spline_reserve(Spline* spline, int capacity) {
+    if (spline->points_capacity >= capacity) {
+        return;
+    }
+    spline->points_capacity = capacity;
+    spline->points = realloc(spline->points, capacity * sizeof(ControlPoint));
+    spline->curves = realloc(spline->curves, capacity * sizeof(CubicCurve));
+}
+
+void spline_free(Spline* spline) {
+    free(spline->points);
+    free(spline->curves);
+    spline->points = NULL;
+    spline->curves = NULL;
+    spline->points_capacity = 0;
+    spline->n_points = 0;
+}
+
 void spline_push_back_point(Spline* spline, ControlPoint point) {
     const int INITIAL_CAPACITY = 10;
     const int GROWTH_FACTOR = 2;
 
     if (spline->points_capacity == 0) {
-        spline->points_capacity = INITIAL_CAPACITY;
-        spline->points = malloc(INITIAL_CAPACITY * sizeof(ControlPoint));
-        spline->curves = malloc(INITIAL_CAPACITY * sizeof(CubicCurve));
+        spline_reserve(spline, INITIAL_CAPACITY);
     }
     else if (spline->n_points == spline->points_capacity) {
         int new_capacity = GROWTH_FACTOR * spline->points_capacity;
         printf("Realloc: cap: %d, new_cap: %d\n", spline->points_capacity, new_capacity);
-        spline->points_capacity = new_capacity;
-        spline->points = realloc(spline->points, new_capacity * sizeof(ControlPoint));
-        spline->curves = realloc(spline->curves, new_capacity * sizeof(CubicCurve));
+        spline_reserve(spline, new_capacity);
     }
 
     spline->points[spline->n_points] = point;
@@ -427,71 +758,260 @@ void spline_push_back_point(Spline* spline, ControlPoint point) {
     spline->n_points++;
 }
 
-void spline_calculate_curves(Spline* spline) {
+// a point's tangent depends on its neighbours, a curve on both of its points:
+// moving the points in [point_lo, point_hi] touches points and curves in this range
+void spline_get_affected_range(Spline* spline, int point_lo, int point_hi, int* lo, int* hi) {
+    *lo = (point_lo - 2 < 0) ? 0 : point_lo - 2;
+    *hi = (point_hi + 1 > spline->n_points - 1) ? spline->n_points - 1 : point_hi + 1;
+}
+
+// recalculates only the tangents and curves that depend on the points in [point_lo, point_hi]
+void spline_calculate_curves_range(Spline* spline, int point_lo, int point_hi) {
     if (spline->n_points < 2) {
         // cannot have curve yet
         return;
     }
 
-    // tangents for first and last point are controlable constraints
-    // just like the point coordinates
-    spline->points[0].tangent = spline->begin_tangent_normalized;
-    spline->points[spline->n_points-1].tangent = spline->end_tangent_normalized;
+    int last = spline->n_points - 1;
+    int tangent_lo = (point_lo - 1 < 0) ? 0 : point_lo - 1;
+    int tangent_hi = (point_hi + 1 > last) ? last : point_hi + 1;
 
-    // calculate tangents for points in the middle
-    for (int i = 1; i < spline->n_points-1; i++) {
-        spline->points[i].tangent = Vector2Subtract(
-            spline->points[i+1].coord,
-            spline->points[i-1].coord
-        );
+    for (int i = tangent_lo; i <= tangent_hi; i++) {
+        if (i == 0) {
+            // tangents for first and last point are controlable constraints
+            // just like the point coordinates
+            spline->points[i].tangent = spline->begin_tangent_normalized;
+        }
+        else if (i == last) {
+            spline->points[i].tangent = spline->end_tangent_normalized;
+        }
+        else {
+            // calculate tangents for points in the middle
+            spline->points[i].tangent = Vector2Subtract(
+                spline->points[i+1].coord,
+                spline->points[i-1].coord
+            );
+        }
     }
 
-    for (int i = 0; i < spline->n_points-1; i++) {
+    int curve_lo = (tangent_lo - 1 < 0) ? 0 : tangent_lo - 1;
+    int curve_hi = (tangent_hi > last - 1) ? last - 1 : tangent_hi;
+    for (int i = curve_lo; i <= curve_hi; i++) {
         solve_cubic_curve(spline->points[i], spline->points[i+1], &spline->curves[i]);
     }
 }
 
-void spline_draw_curves(Spline* spline, SplineStyle style, Axis2D axis, int point_hold) {
-    // printf("draw spline: %d\n", spline->n_points);
+void spline_calculate_curves(Spline* spline) {
+    spline_calculate_curves_range(spline, 0, spline->n_points - 1);
+}
+
+// binary search over the control points, they are kept ordered by x
+// returns the index of the first point with coord.x >= x, n_points if there is none
+int spline_lower_bound(Spline* spline, float x) {
+    int low = 0;
+    int high = spline->n_points;
+    while (low < high) {
+        int mid = low + (high - low)/2;
+        if (spline->points[mid].coord.x < x) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// curve i spans [points[i].coord.x, points[i+1].coord.x], x outside the spline maps onto the end curves
+int spline_find_curve(Spline* spline, float x) {
+    int i = spline_lower_bound(spline, x) - 1;
+    if (i > spline->n_points - 2) i = spline->n_points - 2;
+    if (i < 0) i = 0;
+    return i;
+}
+
+float spline_curve_calculate(Spline* spline, int i, float x) {
+    return cubic_curve_calculate(spline->curves[i], x - spline->points[i].coord.x);
+}
+
+const float CURVE_LOD_PIXELS_PER_VERTEX = 2;
+
+typedef struct {
+    int vertices_capacity;
+    int first_vertex;       // vertices before it have scrolled out of the view
+    int n_vertices;
+    Vector2* vertices;      // in global coordinates, ready to draw
+    // what the vertices were made with, the cache can only be extended under the same ones
+    Axis2D axis;
+    float lod_step;
+} CurveTessellation;
+
+Vector2* curve_tessellation_get_vertices(CurveTessellation* tessellation) {
+    return tessellation->vertices + tessellation->first_vertex;
+}
+
+// makes room for count more vertices
+void curve_tessellation_reserve(CurveTessellation* tessellation, int count) {
+    int needed = tessellation->n_vertices + count;
+
+    // move the kept vertices back to the start before growing
+    if (tessellation->first_vertex > 0 && tessellation->first_vertex + needed > tessellation->vertices_capacity) {
+        memmove(
+            tessellation->vertices,
+            curve_tessellation_get_vertices(tessellation),
+            tessellation->n_vertices * sizeof(Vector2)
+        );
+        tessellation->first_vertex = 0;
+    }
+    // twice the need, so the next move is at least as many vertices away
+    if (2 * needed > tessellation->vertices_capacity) {
+        tessellation->vertices_capacity = 2 * needed;
+        tessellation->vertices = realloc(tessellation->vertices, tessellation->vertices_capacity * sizeof(Vector2));
+    }
+}
+
+float curve_tessellation_vertex_x(CurveTessellation* tessellation, int i) {
+    return axis2d_shift_into(tessellation->axis, curve_tessellation_get_vertices(tessellation)[i]).x;
+}
+
+void curve_tessellation_push(CurveTessellation* tessellation, Spline* spline, int i, float x) {
+    curve_tessellation_get_vertices(tessellation)[tessellation->n_vertices++] = axis2d_shift_out(
+        tessellation->axis,
+        (Vector2) {x, spline_curve_calculate(spline, i, x)}
+    );
+}
+
+// continues the tessellation from a vertex at x up to x_end
+void spline_tessellate_range(Spline* spline, float x, float x_end, CurveTessellation* tessellation) {
+    float lod_step = tessellation->lod_step;
+    // one vertex per step, plus at most one joint per step
+    curve_tessellation_reserve(tessellation, 2 * (int)ceilf((x_end - x) / lod_step) + 4);
+
+    int i = spline_find_curve(spline, x);
+    while (x < x_end) {
+        float x_next = fminf(x + lod_step, x_end);
+
+        // keep the joints exact while curves are wider than a vertex step
+        float joint = spline->points[i+1].coord.x;
+        float curve_width = joint - spline->points[i].coord.x;
+        if (x < joint && joint < x_next && curve_width >= lod_step) {
+            x_next = joint;
+        }
+
+        if (x_next > joint) {
+            i = spline_find_curve(spline, x_next);
+        }
+
+        x = x_next;
+        curve_tessellation_push(tessellation, spline, i, x);
+    }
+}
+
+// Only the part of the spline inside the view is tessellated, one vertex every
+// CURVE_LOD_PIXELS_PER_VERTEX screen pixels. Cost follows the visible pixels,
+// not the number of curves: when curves get narrower than a vertex step they
+// are jumped over with a binary search instead of being walked one by one.
+void spline_tessellate_curves(Spline* spline, Axis2D axis, GraphView view, CurveTessellation* tessellation) {
+    tessellation->first_vertex = 0;
+    tessellation->n_vertices = 0;
+    tessellation->axis = axis;
+    tessellation->lod_step = CURVE_LOD_PIXELS_PER_VERTEX / view.pixels_per_unit;
+    if (spline->n_points < 2) {
+        return;
+    }
+
+    float x_begin = fmaxf(view.x_min, spline->points[0].coord.x);
+    float x_end = fminf(view.x_max, spline->points[spline->n_points - 1].coord.x);
+    if (x_begin >= x_end) {
+        return;
+    }
+
+    curve_tessellation_reserve(tessellation, 1);
+    curve_tessellation_push(tessellation, spline, spline_find_curve(spline, x_begin), x_begin);
+    spline_tessellate_range(spline, x_begin, x_end, tessellation);
+}
+
+// For splines that grow on the right and shrink on the left while the view
+// follows them. The previous tessellation is shifted instead of rebuilt:
+// vertices that scrolled out on the left are dropped, the tail from dirty_x
+// on (curves re-solved since the last call) is cut and the end is extended.
+// Falls back to a rebuild when the axis, the zoom or the view jumped.
+void spline_tessellate_curves_shifting(Spline* spline, Axis2D axis, GraphView view, float dirty_x, CurveTessellation* tessellation) {
+    float lod_step = CURVE_LOD_PIXELS_PER_VERTEX / view.pixels_per_unit;
+    bool same_frame = tessellation->n_vertices >= 2
+        && tessellation->lod_step == lod_step
+        && Vector2Equals(tessellation->axis.origin, axis.origin)
+        && Vector2Equals(tessellation->axis.orientation, axis.orientation)
+        && tessellation->axis.scale == axis.scale;
+    if (!same_frame || spline->n_points < 2) {
+        spline_tessellate_curves(spline, axis, view, tessellation);
+        return;
+    }
+
+    float x_begin = fmaxf(view.x_min, spline->points[0].coord.x);
+    float x_end = fminf(view.x_max, spline->points[spline->n_points - 1].coord.x);
+    float x_keep = fminf(dirty_x, x_end);
+    if (x_begin >= x_end
+        || curve_tessellation_vertex_x(tessellation, 0) > x_begin
+        || curve_tessellation_vertex_x(tessellation, 0) > x_keep
+        || curve_tessellation_vertex_x(tessellation, tessellation->n_vertices - 1) < x_begin
+    ) {
+        spline_tessellate_curves(spline, axis, view, tessellation);
+        return;
+    }
+
+    // scrolled out, one vertex is kept left of the view so the curve reaches its edge
+    while (tessellation->n_vertices >= 2 && curve_tessellation_vertex_x(tessellation, 1) <= x_begin) {
+        tessellation->first_vertex++;
+        tessellation->n_vertices--;
+    }
+    // re-solved or past the view
+    while (tessellation->n_vertices >= 2 && curve_tessellation_vertex_x(tessellation, tessellation->n_vertices - 1) > x_keep) {
+        tessellation->n_vertices--;
+    }
+
+    float x_last = curve_tessellation_vertex_x(tessellation, tessellation->n_vertices - 1);
+    if (x_last < x_end) {
+        spline_tessellate_range(spline, x_last, x_end, tessellation);
+    }
+}
 
+void spline_draw_curves(CurveTessellation* tessellation, SplineStyle style, GraphView view) {
     // draw curves
     // printf("draw curves\n");
-    const int curve_split = 100;
-    float xc0, yc0, xc1, yc1;
-    for (int i = 0; i < spline->n_points - 1; i++) {
-        float x1 = spline->points[i].coord.x;
-        float x2 = spline->points[i+1].coord.x;
-        float step = (x2-x1)/curve_split;
-
-        xc0 = x1;
-        yc0 = cubic_curve_calculate(spline->curves[i], xc0);
-        for (int j = 1; j <= curve_split; j++) {
-            float xc1 = x1 + ((j+1) * step);
-            float yc1 = cubic_curve_calculate(spline->curves[i], xc1);
-            DrawLineEx(
-                axis2d_shift_out(axis, (Vector2) {xc0, yc0}),
-                axis2d_shift_out(axis, (Vector2) {xc1, yc1}),
-                2,
-                style.curve_color
-            );
-            xc0 = xc1;
-            yc0 = yc1;
-        }
+    if (tessellation->n_vertices >= 2) {
+        DrawSplineLinear(curve_tessellation_get_vertices(tessellation), tessellation->n_vertices, 2 / view.zoom, style.curve_color);
     }
+}
 
+void spline_draw_control_points(Spline* spline, SplineStyle style, Axis2D axis, GraphView view, int point_hold) {
     // draw control points
     // printf("draw points\n");
-    for (int i = 0; i < spline->n_points; i++) {
-        int radius = style.control_point_radius;
-        Color color = style.control_point_idle_color;
-        if (i == point_hold) {
-            radius *= 1.5;
-            color = style.control_point_hold_color;
+    // sizes in style are in screen pixels, keep them so under zoom
+    float radius = style.control_point_radius / view.zoom;
+    float local_radius = radius / axis.scale;
+    int i = spline_lower_bound(spline, view.x_min - local_radius);
+    while (i < spline->n_points && spline->points[i].coord.x <= view.x_max + local_radius) {
+        if (i != point_hold) {
+            DrawCircleV(
+                axis2d_shift_out(axis, spline->points[i].coord),
+                radius,
+                style.control_point_idle_color
+            );
+        }
+
+        // points closer than a radius overlap on screen, jump past them
+        int next = i + 1;
+        if (next < spline->n_points && spline->points[next].coord.x < spline->points[i].coord.x + local_radius) {
+            next = spline_lower_bound(spline, spline->points[i].coord.x + local_radius);
         }
+        i = next;
+    }
+    if (point_hold != -1) {
         DrawCircleV(
-            axis2d_shift_out(axis, spline->points[i].coord),
-            radius,
-            color
+            axis2d_shift_out(axis, spline->points[point_hold].coord),
+            radius * 1.5,
+            style.control_point_hold_color
         );
     }
 
@@ -499,158 +1019,2178 @@ void spline_draw_curves(Spline* spline, SplineStyle style, Axis2D axis, int poin
     if (spline->n_points > 0) {
         // float bt_angle = Vector2Angle((Vector2) {1, 0}, spline->begin_tangent_normalized);
         Arrow bt_neg_arrow = {
-            .head_radius = style.arrow_head_radius,
+            .head_radius = style.arrow_head_radius / view.zoom,
             .base = axis2d_shift_out(axis, spline->points[0].coord),
             .direction = axis2d_orient_out(axis, spline->begin_tangent_normalized),
-            .length = style.arrow_length,
+            .length = style.arrow_length / view.zoom,
         };
-        arrow_draw(bt_neg_arrow, 3, BLACK);
+        arrow_draw(bt_neg_arrow, 3 / view.zoom, BLACK);
 
         if (spline->n_points > 1) {
             // float bt_angle = Vector2Angle((Vector2) {1, 0}, spline->end_tangent_normalized);
             Arrow bt_neg_arrow = {
-                .head_radius = style.arrow_head_radius,
+                .head_radius = style.arrow_head_radius / view.zoom,
                 .base = axis2d_shift_out(axis, spline->points[spline->n_points - 1].coord),
                 .direction = axis2d_orient_out(axis, spline->end_tangent_normalized),
-                .length = style.arrow_length,
+                .length = style.arrow_length / view.zoom,
             };
-            arrow_draw(bt_neg_arrow, 3, BLACK);
+            arrow_draw(bt_neg_arrow, 3 / view.zoom, BLACK);
         }
     }
 }
 
-typedef struct {
-    Graph2DCanvas graph2d_canvas;
-    Spline spline;
-    SplineStyle spline_style;
-    // -- System Data --
-    Vector2 relative_mouse;
-    bool spline_updated;
-    int point_hold;
-    bool begin_tangent_hold;
-    bool end_tangent_hold;
-} SplineEntity;
+// -- Fixed Point --
+// Q16.16 form of solved curves for consumers without a fast FPU. Each curve
+// is re-parameterized over its width, t in [0, 1]:
+//     y = ((a*t + b)*t + c)*t + d
+// With t <= 1 every Horner partial is bounded by |a| + |b| + |c| + |d|.
+// Conversion refuses curves where that sum, or any joint x, is over
+// Q16_SAFE_MAX, so all partials fit in int32 and all products in int64.
+// x outside the joints is clamped to the end points, flat, where the float
+// path extrapolates the end curves.
 
-SplineEntity spline_entity_create_default(int id) {
+typedef int32_t q16;
 
-    Rectangle graph2d_canvas_rect = {
-        .x = 100,
-        .y = 100,
-        .width = 800,
-        .height = 400,
-    };
-    Graph2DCanvas graph2d_canvas = graph2d_canvas_create_default(id, graph2d_canvas_rect);
+#define Q16_ONE (1 << 16)
+#define Q16_SAFE_MAX 32767.0
 
-    Spline spline = new_init_spline();
+q16 q16_from_float(double f) {
+    return (q16) llround(f * Q16_ONE);
+}
 
-    SplineStyle spline_style = {
-        .arrow_head_radius = 20,
-        .arrow_length = 100,
-        .control_point_radius = 10,
-        .control_point_idle_color = RED,
-        .control_point_hold_color = MAGENTA,
-        .curve_color = BLUE,
-    };
+float q16_to_float(q16 q) {
+    return q / (float) Q16_ONE;
+}
 
-    return (SplineEntity) {
-        .graph2d_canvas = graph2d_canvas,
-        .spline = spline,
-        .spline_style = spline_style,
-        // -- System Data --
-        .relative_mouse = {0, 0},
-        .spline_updated = false,
-        .point_hold = -1,
-        .begin_tangent_hold = false,
-        .end_tangent_hold = false,
-    };
+q16 q16_mul(q16 a, q16 b) {
+    return (q16) (((int64_t) a * b) >> 16);
 }
 
-void spline_entity_set_input(SplineEntity* spline_entity, Camera2D camera) {
-    Vector2 mouse = GetScreenToWorld2D(GetMousePosition(), camera);
-    spline_entity->relative_mouse = axis2d_shift_into(spline_entity->graph2d_canvas.canvas.axis, mouse);
+typedef struct {
+    q16 a, b, c, d;
+} FixedCurve;
+
+q16 fixed_curve_calculate(FixedCurve curve, q16 t) {
+    q16 y = curve.a;
+    y = q16_mul(y, t) + curve.b;
+    y = q16_mul(y, t) + curve.c;
+    y = q16_mul(y, t) + curve.d;
+    return y;
 }
 
-void spline_entity_process_input(SplineEntity* spline_entity) {
-    Graph2DCanvas* graph2d_canvas = &spline_entity->graph2d_canvas;
-    Spline* spline = &spline_entity->spline;
-    SplineStyle* spline_style = &spline_entity->spline_style;
-    bool* set_spline_updated = &spline_entity->spline_updated;
-    int* set_point_hold = &spline_entity->point_hold;
-    bool* set_begin_tangent_hold = &spline_entity->begin_tangent_hold;
-    bool* set_end_tangent_hold = &spline_entity->end_tangent_hold;
+void fixed_curve_calculate_batch_scalar(FixedCurve curve, const q16* t, q16* y, int count) {
+    for (int i = 0; i < count; i++) {
+        y[i] = fixed_curve_calculate(curve, t[i]);
+    }
+}
 
-    Vector2 relative_mouse = spline_entity->relative_mouse;
+#ifdef CURVEMAKER_X86
+// 32x32 -> 64 multiplies only exist for the even lanes: do evens and odds
+// separately and put the middle 32 bits of each product back in its lane.
+// The low 32 bits of a logical and an arithmetic shift are the same, so
+// results match q16_mul bit for bit.
+__attribute__((target("sse4.1"), always_inline))
+static inline __m128i q16_mul_sse41(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epi32(a, b);
+    __m128i odd = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_blend_epi16(_mm_srli_epi64(even, 16), _mm_slli_epi64(odd, 16), 0xCC);
+}
 
-    Axis2D axis = graph2d_canvas->canvas.axis;
-    float x_axis_len = graph2d_canvas->axis_len.x;
-    float y_axis_len = graph2d_canvas->axis_len.y;
-    float local_spline_style_arrow_length = axis2d_scale_into(axis, spline_style->arrow_length);
-    float local_spline_style_arrow_head_radius = axis2d_scale_into(axis, spline_style->arrow_head_radius);
-    float local_spline_style_control_point_radius = axis2d_scale_into(axis, spline_style->control_point_radius);
+__attribute__((target("sse4.1")))
+void fixed_curve_calculate_batch_sse41(FixedCurve curve, const q16* t, q16* y, int count) {
+    __m128i a = _mm_set1_epi32(curve.a);
+    __m128i b = _mm_set1_epi32(curve.b);
+    __m128i c = _mm_set1_epi32(curve.c);
+    __m128i d = _mm_set1_epi32(curve.d);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i ti = _mm_loadu_si128((const __m128i*) &t[i]);
+        __m128i yi = _mm_add_epi32(q16_mul_sse41(a, ti), b);
+        yi = _mm_add_epi32(q16_mul_sse41(yi, ti), c);
+        yi = _mm_add_epi32(q16_mul_sse41(yi, ti), d);
+        _mm_storeu_si128((__m128i*) &y[i], yi);
+    }
+    fixed_curve_calculate_batch_scalar(curve, &t[i], &y[i], count - i);
+}
 
-    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-        printf("mouse: %0.2f, %0.2f\n", relative_mouse.x, relative_mouse.y);
+__attribute__((target("avx2"), always_inline))
+static inline __m256i q16_mul_avx2(__m256i a, __m256i b) {
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi16(_mm256_srli_epi64(even, 16), _mm256_slli_epi64(odd, 16), 0xCC);
+}
 
-        if (spline->n_points > 0) {
-            Vector2 begin_neg_tangent_head = Vector2Add(
-                spline->points[0].coord,
-                Vector2Scale(spline->begin_tangent_normalized, local_spline_style_arrow_length)
-            );
-            if (Vector2DistanceSqr(begin_neg_tangent_head, relative_mouse) <= f_sq(local_spline_style_arrow_head_radius)) {
-                *set_begin_tangent_hold = true;
-                goto END_HOLD_CHECK;
-            }
+__attribute__((target("avx2")))
+void fixed_curve_calculate_batch_avx2(FixedCurve curve, const q16* t, q16* y, int count) {
+    __m256i a = _mm256_set1_epi32(curve.a);
+    __m256i b = _mm256_set1_epi32(curve.b);
+    __m256i c = _mm256_set1_epi32(curve.c);
+    __m256i d = _mm256_set1_epi32(curve.d);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i ti = _mm256_loadu_si256((const __m256i*) &t[i]);
+        __m256i yi = _mm256_add_epi32(q16_mul_avx2(a, ti), b);
+        yi = _mm256_add_epi32(q16_mul_avx2(yi, ti), c);
+        yi = _mm256_add_epi32(q16_mul_avx2(yi, ti), d);
+        _mm256_storeu_si256((__m256i*) &y[i], yi);
+    }
+    fixed_curve_calculate_batch_scalar(curve, &t[i], &y[i], count - i);
+}
+#endif
 
-            if (spline->n_points > 1) {
-                Vector2 end_neg_tangent_head = Vector2Add(
-                    spline->points[spline->n_points - 1].coord,
-                    Vector2Scale(spline->end_tangent_normalized, local_spline_style_arrow_length)
-                );
-                if (Vector2DistanceSqr(end_neg_tangent_head, relative_mouse) <= f_sq(local_spline_style_arrow_head_radius)) {
-                    *set_end_tangent_hold = true;
-                    goto END_HOLD_CHECK;
-                }
-            }
-        }
+typedef void (*FixedCurveBatchFn)(FixedCurve curve, const q16* t, q16* y, int count);
 
-        for (int i = 0; i < spline->n_points; i++) {
-            Vector2 coord = spline->points[i].coord;
-            if (Vector2DistanceSqr(coord, relative_mouse) <= f_sq(local_spline_style_control_point_radius)) {
-                *set_point_hold = i;
-                goto END_HOLD_CHECK;
-            }
-        }
+FixedCurveBatchFn fixed_curve_select_batch() {
+#ifdef CURVEMAKER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return fixed_curve_calculate_batch_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return fixed_curve_calculate_batch_sse41;
+    }
+#endif
+    return fixed_curve_calculate_batch_scalar;
+}
 
-        float x_low_limit = (spline->n_points == 0) ? 0 : spline->points[spline->n_points - 1].coord.x;
-        float x_high_limit = x_axis_len;
-        float limit_margin = local_spline_style_control_point_radius;
-        Vector2 low_limit = {
-            .x = x_low_limit + limit_margin,
-            .y = limit_margin,
-        };
-        Vector2 high_limit = {
-            .x = x_high_limit - limit_margin,
-            .y = y_axis_len - limit_margin,
-        };
+FixedCurveBatchFn FIXED_CURVE_CALCULATE_BATCH = NULL; // picked for the running cpu on first use
 
-        printf("low_limit: %0.2f, %0.2f\n", low_limit.x, low_limit.y);
-        printf("high_limit: %0.2f, %0.2f\n", high_limit.x, high_limit.y);
+void fixed_curve_calculate_batch(FixedCurve curve, const q16* t, q16* y, int count) {
+    if (FIXED_CURVE_CALCULATE_BATCH == NULL) {
+        FIXED_CURVE_CALCULATE_BATCH = fixed_curve_select_batch();
+    }
+    FIXED_CURVE_CALCULATE_BATCH(curve, t, y, count);
+}
 
-        if (low_limit.x <= relative_mouse.x && relative_mouse.x <= high_limit.x
+typedef struct {
+    int n_curves;
+    q16* x;                 // joints, n_curves + 1
+    FixedCurve* curves;
+    float max_error;        // largest |fixed - float| the conversion saw, in y units
+} FixedSpline;
+
+const int FIXED_ERROR_SAMPLES = 16; // per curve, off the Q16 grid, to measure the error against the float path
+
+void fixed_spline_free(FixedSpline* fixed) {
+    free(fixed->x);
+    free(fixed->curves);
+    *fixed = (FixedSpline) {0};
+}
+
+// 0 for a spline without curves
+q16 fixed_spline_calculate(FixedSpline* fixed, q16 x) {
+    if (fixed->n_curves < 1) {
+        return 0;
+    }
+
+    // same search as spline_find_curve, over the joints
+    int low = 0;
+    int high = fixed->n_curves + 1;
+    while (low < high) {
+        int mid = low + (high - low)/2;
+        if (fixed->x[mid] < x) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    int i = low - 1;
+    if (i > fixed->n_curves - 1) i = fixed->n_curves - 1;
+    if (i < 0) i = 0;
+
+    // joints span up to twice the int32 range, differences are taken in int64
+    int64_t width = (int64_t) fixed->x[i+1] - fixed->x[i];
+    // rounded, truncating would put every t up to a step low
+    int64_t offset = ((int64_t) x - fixed->x[i]) * Q16_ONE;
+    int64_t t = ((offset >= 0) ? offset + width/2 : offset - width/2) / width;
+    if (t < 0) t = 0;
+    if (t > Q16_ONE) t = Q16_ONE;
+    return fixed_curve_calculate(fixed->curves[i], (q16) t);
+}
+
+// false when the spline has no curve, is out of the overflow safe range (see
+// Fixed Point) or has joints closer than a Q16 step; the result has no curves then
+bool fixed_spline_from_spline(Spline* spline, FixedSpline* fixed) {
+    fixed->n_curves = 0;
+    fixed->max_error = 0;
+    if (spline->n_points < 2) {
+        printf("Fixed: a spline needs 2 points to have a curve\n");
+        return false;
+    }
+
+    int n_curves = spline->n_points - 1;
+    fixed->x = realloc(fixed->x, (n_curves + 1) * sizeof(q16));
+    fixed->curves = realloc(fixed->curves, (n_curves + 1) * sizeof(FixedCurve));
+
+    for (int i = 0; i < spline->n_points; i++) {
+        if (fabsf(spline->points[i].coord.x) > Q16_SAFE_MAX) {
+            printf("Fixed: point %d is out of the overflow safe range\n", i);
+            return false;
+        }
+        fixed->x[i] = q16_from_float(spline->points[i].coord.x);
+        // a curve of zero width in Q16 has no t to map x onto
+        if (i > 0 && fixed->x[i] <= fixed->x[i-1]) {
+            printf("Fixed: points %d and %d are closer than a Q16 step\n", i - 1, i);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < n_curves; i++) {
+        CubicCurve curve = spline->curves[i];
+        double w = spline->points[i+1].coord.x - spline->points[i].coord.x;
+        double a = curve.a * w * w * w;
+        double b = curve.b * w * w;
+        double c = curve.c * w;
+        double d = curve.d;
+        if (fabs(a) + fabs(b) + fabs(c) + fabs(d) > Q16_SAFE_MAX) {
+            printf("Fixed: curve %d is out of the overflow safe range\n", i);
+            return false;
+        }
+
+        FixedCurve fixed_curve = {
+            .a = q16_from_float(a),
+            .b = q16_from_float(b),
+            .c = q16_from_float(c),
+            .d = q16_from_float(d),
+        };
+        fixed->curves[i] = fixed_curve;
+    }
+    fixed->n_curves = n_curves;
+
+    // error of the whole fixed path against the float path: x rounded onto
+    // the grid, x -> t, coefficients and Horner. Samples are spaced by an odd
+    // fraction of the width so they fall between the grid points.
+    for (int i = 0; i < n_curves; i++) {
+        float x = spline->points[i].coord.x;
+        float w = spline->points[i+1].coord.x - x;
+        for (int s = 0; s < FIXED_ERROR_SAMPLES; s++) {
+            float u = w * (s + 0.381966) / FIXED_ERROR_SAMPLES;
+            float y_float = cubic_curve_calculate(spline->curves[i], u);
+            float y_fixed = q16_to_float(fixed_spline_calculate(fixed, q16_from_float(x + u)));
+            if (fabsf(y_fixed - y_float) > fixed->max_error) {
+                fixed->max_error = fabsf(y_fixed - y_float);
+            }
+        }
+    }
+
+    return true;
+}
+
+// every curve sampled at the same t values, y holds n_curves * count values
+void fixed_spline_bake(FixedSpline* fixed, const q16* t, int count, q16* y) {
+    for (int i = 0; i < fixed->n_curves; i++) {
+        fixed_curve_calculate_batch(fixed->curves[i], t, &y[i * count], count);
+    }
+}
+
+// --bench-fixed N: conversion error and float vs fixed throughput on a synthetic N point spline
+void fixed_spline_benchmark(int n_points) {
+    const int SAMPLES_PER_CURVE = 64;
+    const int ROUNDS = 8;
+
+    if (n_points < 2) n_points = 2;
+    Spline spline = new_init_spline();
+    spline_reserve(&spline, n_points);
+    for (int i = 0; i < n_points; i++) {
+        ControlPoint point = {0};
+        point.coord.x = 300.0 * i / (n_points - 1);
+        point.coord.y = 150 + 100 * sinf(i * 0.05);
+        spline.points[i] = point;
+    }
+    spline.n_points = n_points;
+    spline_calculate_curves(&spline);
+
+    FixedSpline fixed = {0};
+    if (!fixed_spline_from_spline(&spline, &fixed)) {
+        spline_free(&spline);
+        fixed_spline_free(&fixed);
+        return;
+    }
+    printf("Fixed: %d curves, max quantization error %g\n", fixed.n_curves, fixed.max_error);
+
+    int n_samples = fixed.n_curves * SAMPLES_PER_CURVE;
+    float* t_float = malloc(SAMPLES_PER_CURVE * sizeof(float));
+    q16* t_fixed = malloc(SAMPLES_PER_CURVE * sizeof(q16));
+    float* y_float = malloc(n_samples * sizeof(float));
+    q16* y_fixed = malloc(n_samples * sizeof(q16));
+    for (int s = 0; s < SAMPLES_PER_CURVE; s++) {
+        t_float[s] = s / (float) SAMPLES_PER_CURVE;
+        t_fixed[s] = q16_from_float(t_float[s]);
+    }
+
+    clock_t begin = clock();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < fixed.n_curves; i++) {
+            float w = spline.points[i+1].coord.x - spline.points[i].coord.x;
+            for (int s = 0; s < SAMPLES_PER_CURVE; s++) {
+                y_float[i * SAMPLES_PER_CURVE + s] = cubic_curve_calculate(spline.curves[i], t_float[s] * w);
+            }
+        }
+    }
+    double float_seconds = (double) (clock() - begin) / CLOCKS_PER_SEC;
+    printf("Fixed: float  %8.1f M samples/s\n", ROUNDS * n_samples / float_seconds / 1e6);
+
+    FixedCurveBatchFn paths[] = {
+        fixed_curve_calculate_batch_scalar,
+#ifdef CURVEMAKER_X86
+        __builtin_cpu_supports("sse4.1") ? fixed_curve_calculate_batch_sse41 : NULL,
+        __builtin_cpu_supports("avx2") ? fixed_curve_calculate_batch_avx2 : NULL,
+#endif
+    };
+    const char* path_names[] = {"scalar", "sse4.1", "avx2"};
+    for (int p = 0; p < (int) (sizeof(paths) / sizeof(paths[0])); p++) {
+        if (paths[p] == NULL) {
+            continue;
+        }
+        begin = clock();
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < fixed.n_curves; i++) {
+                paths[p](fixed.curves[i], t_fixed, &y_fixed[i * SAMPLES_PER_CURVE], SAMPLES_PER_CURVE);
+            }
+        }
+        double fixed_seconds = (double) (clock() - begin) / CLOCKS_PER_SEC;
+        printf("Fixed: %-6s %8.1f M samples/s\n", path_names[p], ROUNDS * n_samples / fixed_seconds / 1e6);
+    }
+
+    free(t_float);
+    free(t_fixed);
+    free(y_float);
+    free(y_fixed);
+    fixed_spline_free(&fixed);
+    spline_free(&spline);
+}
+
+// -- Parametric Spline --
+// For paths that are not a function of x: loops, vertical tangents, 3D.
+// Segment i runs t in [0, 1] from point i to point i+1 and every component
+// is its own CubicCurve in t,
+//     p_k(t) = a*t^3 + b*t^2 + c*t + d
+// Hermite from the two points and their tangents, the same tangents
+// ControlPoint has (neighbour to neighbour in the middle, a set direction
+// at the ends), used as vectors so there is no slope to divide by.
+// The whole path is parameterized by s in [0, n_points - 1]: segment
+// floor(s), t = s - floor(s).
+// Everything is stored component by component (structure of arrays), so
+// batches evaluate one component for many s with plain vector loads.
+
+#define PARAMETRIC_DIM_MAX 3
+
+typedef struct {
+    int dim;                                    // 2 or 3
+    int n_points;
+    int points_capacity;
+    float* coords[PARAMETRIC_DIM_MAX];          // component k of point i at coords[k][i]
+    float* tangents[PARAMETRIC_DIM_MAX];        // dp/dt at the point
+    CubicCurve* curves[PARAMETRIC_DIM_MAX];     // component k of segment i at curves[k][i]
+    float begin_tangent[PARAMETRIC_DIM_MAX];    // directions at the ends, like Spline's
+    float end_tangent[PARAMETRIC_DIM_MAX];
+} ParametricSpline;
+
+ParametricSpline parametric_spline_create(int dim) {
+    ParametricSpline spline = {0};
+    spline.dim = (dim < 2) ? 2 : (dim > PARAMETRIC_DIM_MAX) ? PARAMETRIC_DIM_MAX : dim;
+    spline.begin_tangent[0] = 1;
+    spline.end_tangent[0] = 1;
+    return spline;
+}
+
+void parametric_spline_reserve(ParametricSpline* spline, int capacity) {
+    if (spline->points_capacity >= capacity) {
+        return;
+    }
+    for (int k = 0; k < spline->dim; k++) {
+        spline->coords[k] = realloc(spline->coords[k], capacity * sizeof(float));
+        spline->tangents[k] = realloc(spline->tangents[k], capacity * sizeof(float));
+        spline->curves[k] = realloc(spline->curves[k], capacity * sizeof(CubicCurve));
+    }
+    spline->points_capacity = capacity;
+}
+
+void parametric_spline_free(ParametricSpline* spline) {
+    for (int k = 0; k < spline->dim; k++) {
+        free(spline->coords[k]);
+        free(spline->tangents[k]);
+        free(spline->curves[k]);
+        spline->coords[k] = NULL;
+        spline->tangents[k] = NULL;
+        spline->curves[k] = NULL;
+    }
+    spline->points_capacity = 0;
+    spline->n_points = 0;
+}
+
+// z is ignored by 2D splines
+void parametric_spline_push_back_point(ParametricSpline* spline, Vector3 coord) {
+    if (spline->n_points == spline->points_capacity) {
+        parametric_spline_reserve(spline, (spline->points_capacity == 0) ? 16 : 2 * spline->points_capacity);
+    }
+    float c[3] = {coord.x, coord.y, coord.z};
+    for (int k = 0; k < spline->dim; k++) {
+        spline->coords[k][spline->n_points] = c[k];
+    }
+    spline->n_points++;
+}
+
+CubicCurve solve_hermite_curve(float p0, float p1, float m0, float m1) {
+    return (CubicCurve) {
+        .a = 2*p0 - 2*p1 + m0 + m1,
+        .b = -3*p0 + 3*p1 - 2*m0 - m1,
+        .c = m0,
+        .d = p0,
+    };
+}
+
+float parametric_spline_chord(ParametricSpline* spline, int i, int j) {
+    float sq = 0;
+    for (int k = 0; k < spline->dim; k++) {
+        sq += f_sq(spline->coords[k][j] - spline->coords[k][i]);
+    }
+    return sqrtf(sq);
+}
+
+// same ranges as spline_calculate_curves_range
+void parametric_spline_calculate_curves_range(ParametricSpline* spline, int point_lo, int point_hi) {
+    if (spline->n_points < 2) {
+        return;
+    }
+
+    int last = spline->n_points - 1;
+    int tangent_lo = (point_lo - 1 < 0) ? 0 : point_lo - 1;
+    int tangent_hi = (point_hi + 1 > last) ? last : point_hi + 1;
+
+    for (int i = tangent_lo; i <= tangent_hi; i++) {
+        if (i == 0 || i == last) {
+            // set directions, as long as the segment they start so the curve
+            // neither overshoots nor flattens near the ends
+            float* direction = (i == 0) ? spline->begin_tangent : spline->end_tangent;
+            float length = (i == 0) ? parametric_spline_chord(spline, 0, 1) : parametric_spline_chord(spline, last - 1, last);
+            for (int k = 0; k < spline->dim; k++) {
+                spline->tangents[k][i] = direction[k] * length;
+            }
+        }
+        else {
+            // neighbour to neighbour like ControlPoint, spread over the two segments it spans
+            for (int k = 0; k < spline->dim; k++) {
+                spline->tangents[k][i] = 0.5 * (spline->coords[k][i+1] - spline->coords[k][i-1]);
+            }
+        }
+    }
+
+    int curve_lo = (tangent_lo - 1 < 0) ? 0 : tangent_lo - 1;
+    int curve_hi = (tangent_hi > last - 1) ? last - 1 : tangent_hi;
+    for (int k = 0; k < spline->dim; k++) {
+        float* p = spline->coords[k];
+        float* m = spline->tangents[k];
+        for (int i = curve_lo; i <= curve_hi; i++) {
+            spline->curves[k][i] = solve_hermite_curve(p[i], p[i+1], m[i], m[i+1]);
+        }
+    }
+}
+
+void parametric_spline_calculate_curves(ParametricSpline* spline) {
+    parametric_spline_calculate_curves_range(spline, 0, spline->n_points - 1);
+}
+
+// The same path as a solved Spline: x runs linearly over each segment and y
+// is the 1D curve re-parameterized over its width, as fixed_spline_from_spline
+// does. Hermite tangents would bend x(t) and could loop back. Editing and
+// re-solving the result afterwards makes it an ordinary parametric spline.
+// A 3D result keeps its dim and gets z = 0 throughout.
+void parametric_spline_from_spline(Spline* spline, ParametricSpline* parametric) {
+    if (parametric->dim < 2) parametric->dim = 2;
+    parametric->n_points = 0;
+    parametric_spline_reserve(parametric, spline->n_points);
+    for (int i = 0; i < spline->n_points; i++) {
+        Vector2 coord = spline->points[i].coord;
+        parametric_spline_push_back_point(parametric, (Vector3) {coord.x, coord.y, 0});
+    }
+    parametric->begin_tangent[0] = spline->begin_tangent_normalized.x;
+    parametric->begin_tangent[1] = spline->begin_tangent_normalized.y;
+    parametric->end_tangent[0] = spline->end_tangent_normalized.x;
+    parametric->end_tangent[1] = spline->end_tangent_normalized.y;
+    for (int k = 2; k < parametric->dim; k++) {
+        parametric->begin_tangent[k] = 0;
+        parametric->end_tangent[k] = 0;
+        for (int i = 0; i < spline->n_points; i++) {
+            parametric->tangents[k][i] = 0;
+            parametric->curves[k][i] = (CubicCurve) {0};
+        }
+    }
+
+    for (int i = 0; i < spline->n_points - 1; i++) {
+        CubicCurve curve = spline->curves[i];
+        float x = spline->points[i].coord.x;
+        float w = spline->points[i+1].coord.x - x;
+        parametric->curves[0][i] = (CubicCurve) {.a = 0, .b = 0, .c = w, .d = x};
+        parametric->curves[1][i] = (CubicCurve) {
+            .a = curve.a * w * w * w,
+            .b = curve.b * w * w,
+            .c = curve.c * w,
+            .d = curve.d,
+        };
+        // dp/dt where the segment starts, the last point takes the end of the last segment
+        parametric->tangents[0][i] = w;
+        parametric->tangents[1][i] = curve.c * w;
+        if (i == spline->n_points - 2) {
+            parametric->tangents[0][i+1] = w;
+            parametric->tangents[1][i+1] = (3 * curve.a * w * w + 2 * curve.b * w + curve.c) * w;
+        }
+    }
+}
+
+// segment of s, and t in it; NaN is taken as the start
+int parametric_spline_find_curve(ParametricSpline* spline, float s, float* t) {
+    int last_curve = spline->n_points - 2;
+    if (!(s >= 0)) s = 0;
+    if (s > last_curve + 1) s = last_curve + 1;
+    int i = (int) s;
+    if (i > last_curve) i = last_curve;
+    *t = s - i;
+    return i;
+}
+
+// Horner, the batch paths do the same operations in the same order
+float parametric_curve_calculate(CubicCurve curve, float t) {
+    return ((curve.a * t + curve.b) * t + curve.c) * t + curve.d;
+}
+
+// p gets dim components; a single point is where the whole path is, an empty spline is at 0
+void parametric_spline_calculate(ParametricSpline* spline, float s, float* p) {
+    if (spline->n_points < 2) {
+        for (int k = 0; k < spline->dim; k++) {
+            p[k] = (spline->n_points == 1) ? spline->coords[k][0] : 0;
+        }
+        return;
+    }
+
+    float t;
+    int i = parametric_spline_find_curve(spline, s, &t);
+    for (int k = 0; k < spline->dim; k++) {
+        p[k] = parametric_curve_calculate(spline->curves[k][i], t);
+    }
+}
+
+// Batches: count values of s in, component k of the point at s[j] out at p[k][j].
+// The paths need at least 2 points, parametric_spline_calculate_batch handles fewer.
+void parametric_spline_calculate_batch_scalar(ParametricSpline* spline, const float* s, int count, float** p) {
+    for (int j = 0; j < count; j++) {
+        float t;
+        int i = parametric_spline_find_curve(spline, s[j], &t);
+        for (int k = 0; k < spline->dim; k++) {
+            p[k][j] = parametric_curve_calculate(spline->curves[k][i], t);
+        }
+    }
+}
+
+#ifdef CURVEMAKER_X86
+// no gathers: four curves are four rows of a, b, c, d, transposed into columns
+__attribute__((target("sse4.1")))
+void parametric_spline_calculate_batch_sse41(ParametricSpline* spline, const float* s, int count, float** p) {
+    __m128 s_max = _mm_set1_ps(spline->n_points - 1);
+    __m128i i_max = _mm_set1_epi32(spline->n_points - 2);
+
+    int j = 0;
+    for (; j + 4 <= count; j += 4) {
+        __m128 sj = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&s[j]), _mm_setzero_ps()), s_max);
+        __m128i ij = _mm_min_epi32(_mm_cvttps_epi32(sj), i_max);
+        __m128 tj = _mm_sub_ps(sj, _mm_cvtepi32_ps(ij));
+        int i0 = _mm_extract_epi32(ij, 0);
+        int i1 = _mm_extract_epi32(ij, 1);
+        int i2 = _mm_extract_epi32(ij, 2);
+        int i3 = _mm_extract_epi32(ij, 3);
+
+        for (int k = 0; k < spline->dim; k++) {
+            const float* curves = (const float*) spline->curves[k];
+            __m128 a = _mm_loadu_ps(&curves[4 * i0]);
+            __m128 b = _mm_loadu_ps(&curves[4 * i1]);
+            __m128 c = _mm_loadu_ps(&curves[4 * i2]);
+            __m128 d = _mm_loadu_ps(&curves[4 * i3]);
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+
+            __m128 pj = _mm_add_ps(_mm_mul_ps(a, tj), b);
+            pj = _mm_add_ps(_mm_mul_ps(pj, tj), c);
+            pj = _mm_add_ps(_mm_mul_ps(pj, tj), d);
+            _mm_storeu_ps(&p[k][j], pj);
+        }
+    }
+
+    float* rest[PARAMETRIC_DIM_MAX];
+    for (int k = 0; k < spline->dim; k++) {
+        rest[k] = &p[k][j];
+    }
+    parametric_spline_calculate_batch_scalar(spline, &s[j], count - j, rest);
+}
+
+// same, eight at a time: rows of lanes j and j+4 share a register, one transpose per 128-bit half
+__attribute__((target("avx2")))
+void parametric_spline_calculate_batch_avx2(ParametricSpline* spline, const float* s, int count, float** p) {
+    __m256 s_max = _mm256_set1_ps(spline->n_points - 1);
+    __m256i i_max = _mm256_set1_epi32(spline->n_points - 2);
+
+    int j = 0;
+    for (; j + 8 <= count; j += 8) {
+        __m256 sj = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(&s[j]), _mm256_setzero_ps()), s_max);
+        __m256i ij = _mm256_min_epi32(_mm256_cvttps_epi32(sj), i_max);
+        __m256 tj = _mm256_sub_ps(sj, _mm256_cvtepi32_ps(ij));
+        int i[8];
+        _mm256_storeu_si256((__m256i*) i, ij);
+
+        for (int k = 0; k < spline->dim; k++) {
+            CubicCurve* curves = spline->curves[k];
+            __m256 r0 = _mm256_set_m128(_mm_loadu_ps(&curves[i[4]].a), _mm_loadu_ps(&curves[i[0]].a));
+            __m256 r1 = _mm256_set_m128(_mm_loadu_ps(&curves[i[5]].a), _mm_loadu_ps(&curves[i[1]].a));
+            __m256 r2 = _mm256_set_m128(_mm_loadu_ps(&curves[i[6]].a), _mm_loadu_ps(&curves[i[2]].a));
+            __m256 r3 = _mm256_set_m128(_mm_loadu_ps(&curves[i[7]].a), _mm_loadu_ps(&curves[i[3]].a));
+            __m256 ab01 = _mm256_unpacklo_ps(r0, r1);
+            __m256 ab23 = _mm256_unpacklo_ps(r2, r3);
+            __m256 cd01 = _mm256_unpackhi_ps(r0, r1);
+            __m256 cd23 = _mm256_unpackhi_ps(r2, r3);
+            __m256 a = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(ab01), _mm256_castps_pd(ab23)));
+            __m256 b = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(ab01), _mm256_castps_pd(ab23)));
+            __m256 c = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(cd01), _mm256_castps_pd(cd23)));
+            __m256 d = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(cd01), _mm256_castps_pd(cd23)));
+
+            __m256 pj = _mm256_add_ps(_mm256_mul_ps(a, tj), b);
+            pj = _mm256_add_ps(_mm256_mul_ps(pj, tj), c);
+            pj = _mm256_add_ps(_mm256_mul_ps(pj, tj), d);
+            _mm256_storeu_ps(&p[k][j], pj);
+        }
+    }
+
+    float* rest[PARAMETRIC_DIM_MAX];
+    for (int k = 0; k < spline->dim; k++) {
+        rest[k] = &p[k][j];
+    }
+    parametric_spline_calculate_batch_scalar(spline, &s[j], count - j, rest);
+}
+#endif
+
+typedef void (*ParametricBatchFn)(ParametricSpline* spline, const float* s, int count, float** p);
+
+ParametricBatchFn parametric_spline_select_batch() {
+#ifdef CURVEMAKER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return parametric_spline_calculate_batch_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return parametric_spline_calculate_batch_sse41;
+    }
+#endif
+    return parametric_spline_calculate_batch_scalar;
+}
+
+ParametricBatchFn PARAMETRIC_SPLINE_CALCULATE_BATCH = NULL; // picked for the running cpu on first use
+
+void parametric_spline_calculate_batch(ParametricSpline* spline, const float* s, int count, float** p) {
+    if (PARAMETRIC_SPLINE_CALCULATE_BATCH == NULL) {
+        PARAMETRIC_SPLINE_CALCULATE_BATCH = parametric_spline_select_batch();
+    }
+    if (spline->n_points < 2) {
+        for (int j = 0; j < count; j++) {
+            float point[PARAMETRIC_DIM_MAX];
+            parametric_spline_calculate(spline, s[j], point);
+            for (int k = 0; k < spline->dim; k++) {
+                p[k][j] = point[k];
+            }
+        }
+        return;
+    }
+    PARAMETRIC_SPLINE_CALCULATE_BATCH(spline, s, count, p);
+}
+
+// Many splines at once, e.g. every motion path of a frame. The samples of
+// all jobs are split evenly between the threads, so one long path does not
+// leave the other threads idle. The calling thread takes the first share.
+// Threads are started and joined on every call, tens of microseconds each,
+// so calls with few samples stay on fewer threads (PARAMETRIC_SAMPLES_PER_THREAD)
+// and it pays off for frames with many paths or dense sampling.
+
+typedef struct {
+    ParametricSpline* spline;
+    const float* s;
+    int count;
+    float* p[PARAMETRIC_DIM_MAX];
+} ParametricJob;
+
+typedef struct {
+    ParametricJob* jobs;
+    int n_jobs;
+    long long sample_lo;    // share of the samples of all jobs in a row
+    long long sample_hi;
+} ParametricShare;
+
+void* parametric_share_run(void* arg) {
+    ParametricShare* share = arg;
+    long long job_begin = 0;
+    for (int j = 0; j < share->n_jobs && job_begin < share->sample_hi; j++) {
+        ParametricJob* job = &share->jobs[j];
+        long long job_end = job_begin + job->count;
+        long long lo = (share->sample_lo > job_begin) ? share->sample_lo : job_begin;
+        long long hi = (share->sample_hi < job_end) ? share->sample_hi : job_end;
+        if (lo < hi) {
+            int offset = lo - job_begin;
+            float* p[PARAMETRIC_DIM_MAX];
+            for (int k = 0; k < job->spline->dim; k++) {
+                p[k] = &job->p[k][offset];
+            }
+            parametric_spline_calculate_batch(job->spline, &job->s[offset], hi - lo, p);
+        }
+        job_begin = job_end;
+    }
+    return NULL;
+}
+
+int cpu_count() {
+#ifdef _WIN32
+    return pthread_num_processors_np();
+#else
+    return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+const int PARAMETRIC_SAMPLES_PER_THREAD = 16384; // fewer are done before a thread would have started
+
+void parametric_calculate_parallel(ParametricJob* jobs, int n_jobs, int n_threads) {
+    long long n_samples = 0;
+    for (int j = 0; j < n_jobs; j++) {
+        n_samples += jobs[j].count;
+    }
+    if (n_threads < 1) n_threads = 1;
+    if (n_threads > n_samples / PARAMETRIC_SAMPLES_PER_THREAD + 1) n_threads = n_samples / PARAMETRIC_SAMPLES_PER_THREAD + 1;
+
+    // dispatch is picked here, not by several threads racing on first use
+    if (PARAMETRIC_SPLINE_CALCULATE_BATCH == NULL) {
+        PARAMETRIC_SPLINE_CALCULATE_BATCH = parametric_spline_select_batch();
+    }
+
+    ParametricShare* shares = malloc(n_threads * sizeof(ParametricShare));
+    pthread_t* threads = malloc(n_threads * sizeof(pthread_t));
+    bool* started = calloc(n_threads, sizeof(bool));
+    for (int t = 0; t < n_threads; t++) {
+        shares[t] = (ParametricShare) {
+            .jobs = jobs,
+            .n_jobs = n_jobs,
+            .sample_lo = n_samples * t / n_threads,
+            .sample_hi = n_samples * (t + 1) / n_threads,
+        };
+        if (t > 0) {
+            started[t] = pthread_create(&threads[t], NULL, parametric_share_run, &shares[t]) == 0;
+        }
+    }
+    // shares whose thread did not start are done here
+    for (int t = 0; t < n_threads; t++) {
+        if (!started[t]) {
+            parametric_share_run(&shares[t]);
+        }
+    }
+    for (int t = 1; t < n_threads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    free(started);
+    free(threads);
+    free(shares);
+}
+
+// --bench-parametric N: batch paths against each other and against the 1D
+// path on N point 2D (looping) and 3D (helix) splines, then many splines in parallel
+void parametric_spline_benchmark(int n_points) {
+    const int SAMPLES_PER_CURVE = 64;
+    const int ROUNDS = 8;
+    const int PARALLEL_SPLINES = 64;
+
+    if (n_points < 2) n_points = 2;
+    int n_samples = (n_points - 1) * SAMPLES_PER_CURVE;
+
+    // 1D reference, the existing Spline path on the same number of curves
+    Spline spline = new_init_spline();
+    spline_reserve(&spline, n_points);
+    for (int i = 0; i < n_points; i++) {
+        ControlPoint point = {0};
+        point.coord.x = 300.0 * i / (n_points - 1);
+        point.coord.y = 150 + 100 * sinf(i * 0.05);
+        spline.points[i] = point;
+    }
+    spline.n_points = n_points;
+    spline_calculate_curves(&spline);
+
+    float* y = malloc(n_samples * sizeof(float));
+    int64_t begin = time_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < n_points - 1; i++) {
+            float w = spline.points[i+1].coord.x - spline.points[i].coord.x;
+            for (int s = 0; s < SAMPLES_PER_CURVE; s++) {
+                y[i * SAMPLES_PER_CURVE + s] = cubic_curve_calculate(spline.curves[i], w * s / SAMPLES_PER_CURVE);
+            }
+        }
+    }
+    double seconds = (time_now_ns() - begin) / 1e9;
+    printf("Parametric: 1D spline    %8.1f M samples/s\n", ROUNDS * n_samples / seconds / 1e6);
+
+    // a curtate cycloid in 2D (loops, vertical tangents), a helix in 3D
+    ParametricSpline paths[2] = {parametric_spline_create(2), parametric_spline_create(3)};
+    for (int i = 0; i < n_points; i++) {
+        float angle = i * 0.3;
+        parametric_spline_push_back_point(&paths[0], (Vector3) {4 * angle - 10 * sinf(angle), 10 * cosf(angle), 0});
+        parametric_spline_push_back_point(&paths[1], (Vector3) {10 * cosf(angle), 10 * sinf(angle), angle});
+    }
+
+    float* s = malloc(n_samples * sizeof(float));
+    for (int j = 0; j < n_samples; j++) {
+        s[j] = j / (float) SAMPLES_PER_CURVE;
+    }
+    float* p[PARAMETRIC_DIM_MAX];
+    float* p_scalar[PARAMETRIC_DIM_MAX];
+    for (int k = 0; k < PARAMETRIC_DIM_MAX; k++) {
+        p[k] = malloc(n_samples * sizeof(float));
+        p_scalar[k] = malloc(n_samples * sizeof(float));
+    }
+
+    ParametricBatchFn batch_paths[] = {
+        parametric_spline_calculate_batch_scalar,
+#ifdef CURVEMAKER_X86
+        __builtin_cpu_supports("sse4.1") ? parametric_spline_calculate_batch_sse41 : NULL,
+        __builtin_cpu_supports("avx2") ? parametric_spline_calculate_batch_avx2 : NULL,
+#endif
+    };
+    const char* batch_path_names[] = {"scalar", "sse4.1", "avx2"};
+
+    for (int d = 0; d < 2; d++) {
+        ParametricSpline* path = &paths[d];
+        parametric_spline_calculate_curves(path);
+
+        // the curves go through their points
+        float max_error = 0;
+        for (int i = 0; i < n_points; i++) {
+            float point[PARAMETRIC_DIM_MAX];
+            parametric_spline_calculate(path, i, point);
+            for (int k = 0; k < path->dim; k++) {
+                max_error = fmaxf(max_error, fabsf(point[k] - path->coords[k][i]));
+            }
+        }
+        printf("Parametric: %dD, %d curves, max error at the points %g\n", path->dim, n_points - 1, max_error);
+
+        parametric_spline_calculate_batch_scalar(path, s, n_samples, p_scalar);
+        for (int b = 0; b < (int) (sizeof(batch_paths) / sizeof(batch_paths[0])); b++) {
+            if (batch_paths[b] == NULL) {
+                continue;
+            }
+            begin = time_now_ns();
+            for (int r = 0; r < ROUNDS; r++) {
+                batch_paths[b](path, s, n_samples, p);
+            }
+            seconds = (time_now_ns() - begin) / 1e9;
+
+            int mismatches = 0;
+            for (int k = 0; k < path->dim; k++) {
+                for (int j = 0; j < n_samples; j++) {
+                    mismatches += p[k][j] != p_scalar[k][j];
+                }
+            }
+            printf("Parametric: %dD %-6s    %8.1f M samples/s, %d differ from scalar\n",
+                path->dim, batch_path_names[b], ROUNDS * n_samples / seconds / 1e6, mismatches);
+        }
+    }
+
+    // every spline its own job and output, all of them evaluated at once,
+    // as many samples in total as above, spread over each whole spline
+    int job_count = n_samples / PARALLEL_SPLINES + 1;
+    float* job_s = malloc(job_count * sizeof(float));
+    for (int j = 0; j < job_count; j++) {
+        job_s[j] = (n_points - 1) * j / (float) job_count;
+    }
+    ParametricJob* jobs = malloc(PARALLEL_SPLINES * sizeof(ParametricJob));
+    float* outputs = malloc((size_t) PARALLEL_SPLINES * 3 * job_count * sizeof(float));
+    for (int j = 0; j < PARALLEL_SPLINES; j++) {
+        jobs[j] = (ParametricJob) {.spline = &paths[1], .s = job_s, .count = job_count};
+        for (int k = 0; k < 3; k++) {
+            jobs[j].p[k] = &outputs[((size_t) j * 3 + k) * job_count];
+        }
+    }
+    parametric_calculate_parallel(jobs, PARALLEL_SPLINES, 1); // touch the outputs once
+    int n_cpus = cpu_count();
+    for (int n_threads = 1; ; n_threads = (2 * n_threads < n_cpus) ? 2 * n_threads : n_cpus) {
+        begin = time_now_ns();
+        for (int r = 0; r < ROUNDS; r++) {
+            parametric_calculate_parallel(jobs, PARALLEL_SPLINES, n_threads);
+        }
+        seconds = (time_now_ns() - begin) / 1e9;
+        printf("Parametric: %d 3D splines, %2d threads %8.1f M samples/s\n",
+            PARALLEL_SPLINES, n_threads, (double) ROUNDS * PARALLEL_SPLINES * job_count / seconds / 1e6);
+        if (n_threads >= n_cpus) {
+            break;
+        }
+    }
+
+    free(jobs);
+    free(job_s);
+    free(outputs);
+    for (int k = 0; k < PARAMETRIC_DIM_MAX; k++) {
+        free(p[k]);
+        free(p_scalar[k]);
+    }
+    free(s);
+    free(y);
+    parametric_spline_free(&paths[0]);
+    parametric_spline_free(&paths[1]);
+    spline_free(&spline);
+}
+
+// -- Shared Memory Publication --
+// Solved curves can also be published to other processes through a POSIX
+// shared-memory segment, layout and read protocol in shared_curves.h. The
+// solver worker writes the inactive slot and flips to it, copying only the
+// range that changed since that slot was last written, same as the triple
+// buffer. Readers map the segment and read in place.
+
+const uint32_t PUBLISH_CAPACITY_DEFAULT = 1 << 16;
+
+typedef struct {
+    char name[64];
+    size_t size;
+    SharedCurvesHeader* header;
+    // stale range per slot, worker only
+    int stale_lo[2];
+    int stale_hi[2];
+    // -- Instrumentation, written by the worker --
+    _Atomic int64_t latency_ns;         // input to visible to readers
+    _Atomic int64_t latency_max_ns;
+} CurvePublisher;
+
+CurvePublisher* curve_publisher_create(const char* name, uint32_t capacity) {
+#ifdef _WIN32
+    printf("Publish: %s: shared memory publication is not supported on this platform\n", name);
+    return NULL;
+#else
+    // never take over a segment another editor is publishing to, its readers would see garbage
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        printf("Publish: shared memory %s already exists, another editor may be publishing to it;"
+            " use another prefix, or remove it if it was left behind by a crash\n", name);
+        return NULL;
+    }
+    if (fd < 0) {
+        printf("Publish: cannot create shared memory %s\n", name);
+        return NULL;
+    }
+    size_t size = shared_curves_size(capacity);
+    if (ftruncate(fd, size) != 0) {
+        printf("Publish: cannot size shared memory %s to %zu bytes\n", name, size);
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        printf("Publish: cannot map shared memory %s\n", name);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    CurvePublisher* publisher = calloc(1, sizeof(CurvePublisher));
+    snprintf(publisher->name, sizeof(publisher->name), "%s", name);
+    publisher->size = size;
+    publisher->header = memory;
+    for (int s = 0; s < 2; s++) {
+        publisher->stale_lo[s] = 0;
+        publisher->stale_hi[s] = INT_MAX;
+    }
+
+    SharedCurvesHeader* header = publisher->header;
+    memset(header, 0, size);
+    header->magic = SHARED_CURVES_MAGIC;
+    header->version = SHARED_CURVES_VERSION;
+    header->capacity = capacity;
+    atomic_store_explicit(&header->active, 0, memory_order_release);
+    return publisher;
+#endif
+}
+
+void curve_publisher_destroy(CurvePublisher* publisher) {
+#ifndef _WIN32
+    munmap(publisher->header, publisher->size);
+    shm_unlink(publisher->name);
+#endif
+    free(publisher);
+}
+
+void curve_publisher_mark_stale(CurvePublisher* publisher, int lo, int hi) {
+    for (int s = 0; s < 2; s++) {
+        if (lo < publisher->stale_lo[s]) publisher->stale_lo[s] = lo;
+        if (hi > publisher->stale_hi[s]) publisher->stale_hi[s] = hi;
+    }
+}
+
+void curve_publisher_publish(CurvePublisher* publisher, Spline* solved, unsigned long long generation, int64_t input_time_ns) {
+    SharedCurvesHeader* header = publisher->header;
+    uint32_t index = 1 - atomic_load_explicit(&header->active, memory_order_relaxed);
+    SharedCurvesSlot* slot = shared_curves_slot(header, index);
+    SharedCurvePoint* points = shared_curves_slot_points(slot);
+
+    // odd sequence: readers still in this slot from before the last flip will retry
+    uint64_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    int n_points = (solved->n_points < (int) header->capacity) ? solved->n_points : (int) header->capacity;
+    int lo = publisher->stale_lo[index];
+    int hi = (publisher->stale_hi[index] < n_points - 1) ? publisher->stale_hi[index] : n_points - 1;
+    for (int i = lo; i <= hi; i++) {
+        Vector2 coord = solved->points[i].coord;
+        // the last point has no curve
+        CubicCurve curve = (i < solved->n_points - 1) ? solved->curves[i] : (CubicCurve) {0};
+        points[i] = (SharedCurvePoint) {
+            .x = coord.x, .y = coord.y,
+            .a = curve.a, .b = curve.b, .c = curve.c, .d = curve.d,
+        };
+    }
+    publisher->stale_lo[index] = INT_MAX;
+    publisher->stale_hi[index] = -1;
+
+    slot->generation = generation;
+    slot->input_time_ns = input_time_ns;
+    slot->n_points = n_points;
+    slot->n_points_total = solved->n_points;
+    slot->begin_tangent[0] = solved->begin_tangent_normalized.x;
+    slot->begin_tangent[1] = solved->begin_tangent_normalized.y;
+    slot->end_tangent[0] = solved->end_tangent_normalized.x;
+    slot->end_tangent[1] = solved->end_tangent_normalized.y;
+    int64_t now = time_now_ns();
+    slot->publish_time_ns = now;
+
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+    atomic_store_explicit(&header->active, index, memory_order_release);
+
+    int64_t latency = now - input_time_ns;
+    atomic_store_explicit(&publisher->latency_ns, latency, memory_order_relaxed);
+    if (latency > atomic_load_explicit(&publisher->latency_max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&publisher->latency_max_ns, latency, memory_order_relaxed);
+    }
+}
+
+#ifndef _WIN32
+// --read-shared NAME: headless reader in its own process, reports how long
+// edits take to become visible to it, polling as fast as it can
+int shared_curves_read(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Read Shared: cannot open shared memory %s\n", name);
+        return 1;
+    }
+    struct stat stat_buffer;
+    fstat(fd, &stat_buffer);
+    size_t size = stat_buffer.st_size;
+    void* memory = (size >= sizeof(SharedCurvesHeader)) ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        printf("Read Shared: cannot map shared memory %s\n", name);
+        return 1;
+    }
+    const SharedCurvesHeader* header = memory;
+    if (header->magic != SHARED_CURVES_MAGIC || header->version != SHARED_CURVES_VERSION || size < shared_curves_size(header->capacity)) {
+        printf("Read Shared: %s is not a curvemaker segment of version %d\n", name, SHARED_CURVES_VERSION);
+        munmap(memory, size);
+        return 1;
+    }
+
+    uint64_t last_generation = 0;
+    int64_t report_time = time_now_ns();
+    unsigned long long updates = 0;
+    unsigned long long retries = 0;
+    int64_t latency_total = 0;
+    int64_t latency_max = 0;
+    while (true) {
+        uint64_t sequence;
+        const SharedCurvesSlot* slot;
+        uint64_t generation;
+        int64_t input_time_ns;
+        uint32_t n_points;
+        float y_sum;
+        while (true) {
+            slot = shared_curves_begin_read(header, &sequence);
+            generation = slot->generation;
+            input_time_ns = slot->input_time_ns;
+            n_points = slot->n_points;
+            // touch the curves so the reported latency covers actually reading them
+            y_sum = 0;
+            const SharedCurvePoint* points = shared_curves_slot_points(slot);
+            for (uint32_t i = 0; i < n_points && i < header->capacity; i++) {
+                y_sum += points[i].d;
+            }
+            if (shared_curves_end_read(slot, sequence)) break;
+            retries++;
+        }
+        int64_t now = time_now_ns();
+
+        if (generation != last_generation) {
+            last_generation = generation;
+            int64_t latency = now - input_time_ns;
+            latency_total += latency;
+            if (latency > latency_max) latency_max = latency;
+            updates++;
+        }
+
+        if (now - report_time >= 1000000000) {
+            printf("generation %llu, %u points (sum %g): %llu updates, latency avg %.1f us max %.1f us, %llu retries\n",
+                (unsigned long long) generation, n_points, y_sum, updates,
+                (updates > 0) ? latency_total / 1000.0 / updates : 0.0, latency_max / 1000.0, retries);
+            fflush(stdout);
+            report_time = now;
+            updates = 0;
+            retries = 0;
+            latency_total = 0;
+            latency_max = 0;
+        }
+        sched_yield();
+    }
+}
+#endif
+
+// -- Background Solver --
+// Curves are solved on a worker thread so a drag never waits for the solve.
+// The render thread posts point edits into a mailbox, edits that pile up
+// before the worker picks them up are merged into one job. The worker keeps
+// its own copy of the spline, re-solves only the affected range and publishes
+// the result through a triple buffer: the renderer swaps to the newest
+// completed buffer without ever blocking on the worker.
+
+typedef struct {
+    int index;
+    Vector2 coord;
+} PointEdit;
+
+typedef struct {
+    int edits_capacity;
+    int n_edits;
+    PointEdit* edits;
+} PointEditList;
+
+void point_edit_list_push(PointEditList* list, PointEdit edit) {
+    // a drag posts the same point every frame, keep only its newest position
+    if (list->n_edits > 0 && list->edits[list->n_edits - 1].index == edit.index) {
+        list->edits[list->n_edits - 1] = edit;
+        return;
+    }
+
+    if (list->n_edits == list->edits_capacity) {
+        list->edits_capacity = (list->edits_capacity == 0) ? 16 : 2 * list->edits_capacity;
+        list->edits = realloc(list->edits, list->edits_capacity * sizeof(PointEdit));
+    }
+    list->edits[list->n_edits++] = edit;
+}
+
+typedef struct {
+    Spline spline;                      // snapshot the curves were solved for
+    unsigned long long generation;      // newest posted edit included
+    unsigned long long input_frame;     // frame the oldest edit included was posted in
+    int64_t input_time_ns;              // and when
+    // stale range, worker only: what changed since this buffer was last written
+    int stale_lo;
+    int stale_hi;
+} SplineCurveBuffer;
+
+#define SPLINE_BUFFER_INDEX_MASK 0x3
+#define SPLINE_BUFFER_FRESH 0x4
+
+typedef struct {
+    pthread_t thread;
+    bool threaded;          // false if the worker did not start, posts are solved right away then
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    // -- Mailbox, guarded by mutex --
+    bool quit;
+    PointEditList pending;
+    int pending_n_points;
+    Vector2 pending_begin_tangent;
+    Vector2 pending_end_tangent;
+    unsigned long long posted_generation;
+    unsigned long long posted_frame;    // oldest post not yet taken, the input the next curves answer
+    int64_t posted_time_ns;
+    unsigned long long taken_generation;
+    CurvePublisher* publisher;
+    // -- Worker Data --
+    Spline solved;
+    CurvePublisher* publishing;         // taken from the mailbox with each job
+    PointEditList taken;
+    unsigned long long solved_generation;
+    int back;
+    // -- Triple Buffer --
+    SplineCurveBuffer buffers[3];
+    atomic_int ready; // index of the newest completed buffer, SPLINE_BUFFER_FRESH until the renderer takes it
+    // -- Render Thread Data --
+    int front;
+    unsigned long long frame;
+    unsigned long long generation;      // newest posted edit, same as posted_generation
+    // -- Instrumentation --
+    int lag_frames;                     // frames the displayed curves are behind the input
+    int lag_frames_max;
+    unsigned long long lag_frames_total;
+    unsigned long long lag_samples;
+    unsigned long long shown_generation;
+    unsigned long long n_updates;       // times the displayed curves changed
+    int64_t update_latency_ns;          // input to displayed, the last time they did
+} SplineSolver;
+
+void spline_solver_apply_taken(SplineSolver* solver, int n_points, Vector2 begin_tangent, Vector2 end_tangent) {
+    Spline* solved = &solver->solved;
+    int point_lo = n_points;
+    int point_hi = -1;
+
+    spline_reserve(solved, n_points);
+    for (int i = 0; i < solver->taken.n_edits; i++) {
+        PointEdit edit = solver->taken.edits[i];
+        if (edit.index >= n_points) {
+            continue;
+        }
+        solved->points[edit.index].coord = edit.coord;
+        if (edit.index < point_lo) point_lo = edit.index;
+        if (edit.index > point_hi) point_hi = edit.index;
+    }
+    solver->taken.n_edits = 0;
+
+    // the old and the new last points switch between end tangent and middle tangent
+    if (n_points != solved->n_points) {
+        int lo = ((n_points < solved->n_points) ? n_points : solved->n_points) - 1;
+        if (lo < 0) lo = 0;
+        if (lo < point_lo) point_lo = lo;
+        if (n_points - 1 > point_hi) point_hi = n_points - 1;
+    }
+    solved->n_points = n_points;
+
+    if (!Vector2Equals(begin_tangent, solved->begin_tangent_normalized)) {
+        solved->begin_tangent_normalized = begin_tangent;
+        point_lo = 0;
+        if (point_hi < 0) point_hi = 0;
+    }
+    if (!Vector2Equals(end_tangent, solved->end_tangent_normalized)) {
+        solved->end_tangent_normalized = end_tangent;
+        if (point_lo > n_points - 1) point_lo = n_points - 1;
+        point_hi = n_points - 1;
+    }
+
+    if (point_lo > point_hi) {
+        return;
+    }
+
+    spline_calculate_curves_range(solved, point_lo, point_hi);
+
+    int lo, hi;
+    spline_get_affected_range(solved, point_lo, point_hi, &lo, &hi);
+    for (int b = 0; b < 3; b++) {
+        SplineCurveBuffer* buffer = &solver->buffers[b];
+        if (lo < buffer->stale_lo) buffer->stale_lo = lo;
+        if (hi > buffer->stale_hi) buffer->stale_hi = hi;
+    }
+    if (solver->publishing != NULL) {
+        curve_publisher_mark_stale(solver->publishing, lo, hi);
+    }
+}
+
+void spline_solver_publish(SplineSolver* solver, unsigned long long input_frame, int64_t input_time_ns) {
+    Spline* solved = &solver->solved;
+    SplineCurveBuffer* buffer = &solver->buffers[solver->back];
+
+    // bring the back buffer up to date, only the ranges it missed are copied
+    spline_reserve(&buffer->spline, solved->n_points);
+    if (buffer->stale_hi >= solved->n_points) buffer->stale_hi = solved->n_points - 1;
+    if (buffer->stale_lo <= buffer->stale_hi) {
+        int count = buffer->stale_hi - buffer->stale_lo + 1;
+        memcpy(&buffer->spline.points[buffer->stale_lo], &solved->points[buffer->stale_lo], count * sizeof(ControlPoint));
+        memcpy(&buffer->spline.curves[buffer->stale_lo], &solved->curves[buffer->stale_lo], count * sizeof(CubicCurve));
+    }
+    buffer->stale_lo = INT_MAX;
+    buffer->stale_hi = -1;
+
+    buffer->spline.n_points = solved->n_points;
+    buffer->spline.begin_tangent_normalized = solved->begin_tangent_normalized;
+    buffer->spline.end_tangent_normalized = solved->end_tangent_normalized;
+    buffer->generation = solver->solved_generation;
+    buffer->input_frame = input_frame;
+    buffer->input_time_ns = input_time_ns;
+
+    solver->back = atomic_exchange(&solver->ready, solver->back | SPLINE_BUFFER_FRESH) & SPLINE_BUFFER_INDEX_MASK;
+}
+
+// called with the mutex held, releases it
+void spline_solver_solve_posted(SplineSolver* solver) {
+    // take everything posted so far in one go, swapping the lists keeps the lock short
+    PointEditList taken = solver->pending;
+    solver->pending = solver->taken;
+    solver->taken = taken;
+    int n_points = solver->pending_n_points;
+    Vector2 begin_tangent = solver->pending_begin_tangent;
+    Vector2 end_tangent = solver->pending_end_tangent;
+    unsigned long long generation = solver->posted_generation;
+    unsigned long long input_frame = solver->posted_frame;
+    int64_t input_time_ns = solver->posted_time_ns;
+    solver->taken_generation = generation;
+    solver->publishing = solver->publisher;
+    pthread_mutex_unlock(&solver->mutex);
+
+    spline_solver_apply_taken(solver, n_points, begin_tangent, end_tangent);
+    solver->solved_generation = generation;
+    spline_solver_publish(solver, input_frame, input_time_ns);
+    if (solver->publishing != NULL) {
+        curve_publisher_publish(solver->publishing, &solver->solved, generation, input_time_ns);
+    }
+}
+
+void* spline_solver_run(void* arg) {
+    SplineSolver* solver = arg;
+
+    while (true) {
+        pthread_mutex_lock(&solver->mutex);
+        while (!solver->quit && solver->posted_generation == solver->solved_generation) {
+            pthread_cond_wait(&solver->cond, &solver->mutex);
+        }
+        if (solver->quit) {
+            pthread_mutex_unlock(&solver->mutex);
+            break;
+        }
+        spline_solver_solve_posted(solver);
+    }
+
+    return NULL;
+}
+
+SplineSolver* spline_solver_create(Spline* spline) {
+    SplineSolver* solver = calloc(1, sizeof(SplineSolver));
+
+    pthread_mutex_init(&solver->mutex, NULL);
+    pthread_cond_init(&solver->cond, NULL);
+
+    solver->pending_begin_tangent = spline->begin_tangent_normalized;
+    solver->pending_end_tangent = spline->end_tangent_normalized;
+    solver->solved = new_init_spline();
+    solver->solved.begin_tangent_normalized = spline->begin_tangent_normalized;
+    solver->solved.end_tangent_normalized = spline->end_tangent_normalized;
+    for (int b = 0; b < 3; b++) {
+        solver->buffers[b].spline = new_init_spline();
+        solver->buffers[b].stale_lo = INT_MAX;
+        solver->buffers[b].stale_hi = -1;
+    }
+    solver->front = 0;
+    solver->back = 1;
+    atomic_init(&solver->ready, 2);
+
+    solver->threaded = pthread_create(&solver->thread, NULL, spline_solver_run, solver) == 0;
+    if (!solver->threaded) {
+        printf("Solver: cannot start the solver thread, solving on the render thread\n");
+    }
+    return solver;
+}
+
+void spline_solver_destroy(SplineSolver* solver) {
+    if (solver->threaded) {
+        pthread_mutex_lock(&solver->mutex);
+        solver->quit = true;
+        pthread_cond_signal(&solver->cond);
+        pthread_mutex_unlock(&solver->mutex);
+        pthread_join(solver->thread, NULL);
+    }
+
+    pthread_mutex_destroy(&solver->mutex);
+    pthread_cond_destroy(&solver->cond);
+    free(solver->pending.edits);
+    free(solver->taken.edits);
+    spline_free(&solver->solved);
+    for (int b = 0; b < 3; b++) {
+        spline_free(&solver->buffers[b].spline);
+    }
+    free(solver);
+}
+
+// posts the points in [point_lo, point_hi] of the render thread's spline, O(edit) not O(spline)
+void spline_solver_post(SplineSolver* solver, Spline* spline, int point_lo, int point_hi, int64_t input_time_ns) {
+    // points may have been removed since they were marked
+    if (point_lo < 0) point_lo = 0;
+    if (point_hi > spline->n_points - 1) point_hi = spline->n_points - 1;
+
+    pthread_mutex_lock(&solver->mutex);
+    for (int i = point_lo; i <= point_hi; i++) {
+        point_edit_list_push(&solver->pending, (PointEdit) {.index = i, .coord = spline->points[i].coord});
+    }
+    solver->pending_n_points = spline->n_points;
+    solver->pending_begin_tangent = spline->begin_tangent_normalized;
+    solver->pending_end_tangent = spline->end_tangent_normalized;
+    if (solver->posted_generation == solver->taken_generation) {
+        // the mailbox was empty, later posts before the worker takes it keep the oldest input
+        solver->posted_frame = solver->frame;
+        solver->posted_time_ns = input_time_ns;
+    }
+    solver->posted_generation = ++solver->generation;
+    if (!solver->threaded) {
+        spline_solver_solve_posted(solver);
+        return;
+    }
+    pthread_cond_signal(&solver->cond);
+    pthread_mutex_unlock(&solver->mutex);
+}
+
+// also publish to shared memory from the next post on, the publisher is not
+// owned by the solver and has to outlive it
+void spline_solver_set_publisher(SplineSolver* solver, CurvePublisher* publisher) {
+    pthread_mutex_lock(&solver->mutex);
+    solver->publisher = publisher;
+    pthread_mutex_unlock(&solver->mutex);
+}
+
+// swaps to the newest solved curves if there are any, without counting a frame
+void spline_solver_swap(SplineSolver* solver) {
+    if (atomic_load(&solver->ready) & SPLINE_BUFFER_FRESH) {
+        solver->front = atomic_exchange(&solver->ready, solver->front) & SPLINE_BUFFER_INDEX_MASK;
+    }
+
+    SplineCurveBuffer* front = &solver->buffers[solver->front];
+    if (front->generation != solver->shown_generation) {
+        solver->shown_generation = front->generation;
+        solver->update_latency_ns = time_now_ns() - front->input_time_ns;
+        solver->n_updates++;
+    }
+}
+
+// called once per frame on the render thread after this frame's posts,
+// swaps to the newest solved curves if there are any
+void spline_solver_acquire(SplineSolver* solver) {
+    spline_solver_swap(solver);
+
+    SplineCurveBuffer* front = &solver->buffers[solver->front];
+    if (front->generation == solver->generation) {
+        solver->lag_frames = 0;
+    }
+    else {
+        // still showing curves solved for an older edit
+        solver->lag_frames = solver->frame - ((front->generation == 0) ? solver->posted_frame : front->input_frame);
+    }
+    if (solver->lag_frames > solver->lag_frames_max) {
+        solver->lag_frames_max = solver->lag_frames;
+    }
+    solver->lag_frames_total += solver->lag_frames;
+    solver->lag_samples++;
+
+    solver->frame++;
+}
+
+float spline_solver_get_lag_frames_mean(SplineSolver* solver) {
+    return (solver->lag_samples == 0) ? 0 : solver->lag_frames_total / (float) solver->lag_samples;
+}
+
+Spline* spline_solver_get_curves(SplineSolver* solver) {
+    return &solver->buffers[solver->front].spline;
+}
+
+// -- Streaming --
+// Live data comes in on the right and the oldest points leave on the left.
+// Points live in a ring of fixed size, each one stored twice (at i and at
+// i + window) so the window is always one contiguous run: `view` is a plain
+// Spline over it and everything that works on a Spline works on the stream.
+
+const int STREAM_WINDOW_DEFAULT = 1 << 16;
+const float STREAM_FOLLOW_AT = 0.9; // newest point is kept at this fraction of the canvas width
+
+typedef struct {
+    int window;             // max points kept
+    int head;               // ring index of the oldest point
+    ControlPoint* points;   // 2 * window
+    CubicCurve* curves;     // 2 * window
+    double x_origin;        // stored x are relative to it, float keeps its precision on long streams
+    Spline view;
+    unsigned long long n_pushed;
+    // -- Consumed by the entity --
+    float dirty_x;          // curves from here on were re-solved, FLT_MAX if none
+    float rebased_dx;       // stored x were shifted left by this much
+} SplineStream;
+
+SplineStream* spline_stream_create(int window) {
+    SplineStream* stream = calloc(1, sizeof(SplineStream));
+    stream->window = (window < 2) ? 2 : window;
+    stream->points = malloc(2 * stream->window * sizeof(ControlPoint));
+    stream->curves = malloc(2 * stream->window * sizeof(CubicCurve));
+    stream->view = new_init_spline();
+    stream->view.points_capacity = stream->window;
+    stream->view.points = stream->points;
+    stream->view.curves = stream->curves;
+    stream->dirty_x = FLT_MAX;
+    return stream;
+}
+
+void spline_stream_destroy(SplineStream* stream) {
+    free(stream->points);
+    free(stream->curves);
+    free(stream);
+}
+
+// writes through the view land in one copy of the ring, bring the other one along
+void spline_stream_mirror(SplineStream* stream, int lo, int hi) {
+    for (int i = lo; i <= hi; i++) {
+        int at = stream->head + i;
+        int other = (at < stream->window) ? at + stream->window : at - stream->window;
+        stream->points[other] = stream->points[at];
+        stream->curves[other] = stream->curves[at];
+    }
+}
+
+// curves are relative to their first point and middle tangents are differences,
+// so shifting x needs no solve
+void spline_stream_rebase(SplineStream* stream) {
+    float dx = stream->view.points[0].coord.x;
+    for (int i = 0; i < stream->view.n_points; i++) {
+        int at = (stream->head + i) % stream->window;
+        stream->points[at].coord.x -= dx;
+        stream->points[at + stream->window].coord.x -= dx;
+    }
+    stream->x_origin += dx;
+    stream->rebased_dx += dx;
+    if (stream->dirty_x != FLT_MAX) {
+        stream->dirty_x -= dx;
+    }
+}
+
+// O(1): evicting is moving the head, appending solves the last two curves
+bool spline_stream_push(SplineStream* stream, double x, float y) {
+    Spline* view = &stream->view;
+
+    if (stream->n_pushed == 0) {
+        stream->x_origin = x;
+    }
+    float local_x = x - stream->x_origin;
+    if (view->n_points > 0 && local_x <= view->points[view->n_points - 1].coord.x) {
+        // spline is a function of x, out of order samples are dropped
+        return false;
+    }
+
+    if (view->n_points == stream->window) {
+        // the new first point keeps its tangent and curve
+        stream->head = (stream->head + 1) % stream->window;
+        view->n_points--;
+    }
+    view->points = stream->points + stream->head;
+    view->curves = stream->curves + stream->head;
+
+    int last = view->n_points;
+    view->points[last] = (ControlPoint) {
+        .coord = {local_x, y},
+        .tangent = {0, 0},
+    };
+    view->n_points++;
+    stream->n_pushed++;
+
+    int lo, hi;
+    spline_calculate_curves_range(view, last, last);
+    spline_get_affected_range(view, last, last, &lo, &hi);
+    spline_stream_mirror(stream, lo, hi);
+    if (view->points[lo].coord.x < stream->dirty_x) {
+        stream->dirty_x = view->points[lo].coord.x;
+    }
+
+    // the window moved past its own width, every point gets shifted once per window
+    float x_first = view->points[0].coord.x;
+    if (x_first > 0 && x_first > view->points[last].coord.x - x_first) {
+        spline_stream_rebase(stream);
+    }
+    return true;
+}
+
+typedef struct {
+    double x;
+    float y;
+} StreamSample;
+
+// Reads "x y" lines, or just "y" lines where x counts the samples, from a
+// file, a pipe or a local socket on its own thread. Samples are handed to
+// the render thread through a single producer single consumer ring, when it
+// is full the reader waits and the pipe pushes back on whoever writes it.
+typedef struct {
+    FILE* file;
+    pthread_t thread;
+    int capacity;               // power of two
+    StreamSample* samples;
+    atomic_uint write_count;    // written by the reader thread only
+    atomic_uint read_count;     // written by the render thread only
+    atomic_bool closed;
+    atomic_bool quit;
+} StreamSource;
+
+const int STREAM_SOURCE_CAPACITY = 1 << 16;
+
+void* stream_source_run(void* arg) {
+    StreamSource* source = arg;
+    char line[256];
+    unsigned long long n_lines = 0;
+
+    while (!atomic_load(&source->quit) && fgets(line, sizeof(line), source->file)) {
+        char* end_first;
+        char* end_second;
+        double first = strtod(line, &end_first);
+        if (end_first == line) {
+            continue;
+        }
+        double second = strtod(end_first, &end_second);
+
+        StreamSample sample;
+        if (end_second != end_first) {
+            sample.x = first;
+            sample.y = second;
+        }
+        else {
+            sample.x = n_lines;
+            sample.y = first;
+        }
+        n_lines++;
+
+        unsigned int write = atomic_load_explicit(&source->write_count, memory_order_relaxed);
+        while (write - atomic_load_explicit(&source->read_count, memory_order_acquire) == (unsigned int)source->capacity) {
+            if (atomic_load(&source->quit)) {
+                goto END_READ;
+            }
+            sched_yield();
+        }
+        source->samples[write & (source->capacity - 1)] = sample;
+        atomic_store_explicit(&source->write_count, write + 1, memory_order_release);
+    }
+
+    END_READ:
+    atomic_store(&source->closed, true);
+    return NULL;
+}
+
+// "-" is stdin, "unix:PATH" a local socket, anything else is opened as a file
+// (regular files, fifos and windows named pipes)
+StreamSource* stream_source_open(const char* path) {
+    FILE* file = NULL;
+    if (strcmp(path, "-") == 0) {
+        file = stdin;
+    }
+    else if (strncmp(path, "unix:", 5) == 0) {
+#ifdef _WIN32
+        printf("Stream: local sockets are not supported on this platform\n");
+#else
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un address = {0};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path + 5, sizeof(address.sun_path) - 1);
+        if (fd >= 0 && connect(fd, (struct sockaddr*) &address, sizeof(address)) == 0) {
+            file = fdopen(fd, "r");
+        }
+        else if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+    else {
+        file = fopen(path, "r");
+    }
+
+    if (file == NULL) {
+        printf("Stream: cannot open %s\n", path);
+        return NULL;
+    }
+
+    StreamSource* source = calloc(1, sizeof(StreamSource));
+    source->file = file;
+    source->capacity = STREAM_SOURCE_CAPACITY;
+    source->samples = malloc(source->capacity * sizeof(StreamSample));
+    atomic_init(&source->write_count, 0);
+    atomic_init(&source->read_count, 0);
+    atomic_init(&source->closed, false);
+    atomic_init(&source->quit, false);
+    if (pthread_create(&source->thread, NULL, stream_source_run, source) != 0) {
+        printf("Stream: cannot start the reader thread for %s\n", path);
+        if (file != stdin) {
+            fclose(file);
+        }
+        free(source->samples);
+        free(source);
+        return NULL;
+    }
+    return source;
+}
+
+// a reader still blocked on its input is left to go down with the process
+void stream_source_close(StreamSource* source) {
+    atomic_store(&source->quit, true);
+    if (!atomic_load(&source->closed)) {
+        pthread_detach(source->thread);
+        return;
+    }
+    pthread_join(source->thread, NULL);
+    if (source->file != stdin) {
+        fclose(source->file);
+    }
+    free(source->samples);
+    free(source);
+}
+
+// moves everything the reader has so far into the stream
+int stream_source_drain(StreamSource* source, SplineStream* stream) {
+    unsigned int read = atomic_load_explicit(&source->read_count, memory_order_relaxed);
+    unsigned int write = atomic_load_explicit(&source->write_count, memory_order_acquire);
+    int count = write - read;
+    for (; read != write; read++) {
+        StreamSample sample = source->samples[read & (source->capacity - 1)];
+        spline_stream_push(stream, sample.x, sample.y);
+    }
+    atomic_store_explicit(&source->read_count, read, memory_order_release);
+    return count;
+}
+
+// -- Undo/Redo Journal --
+// Edits are kept as small deltas instead of snapshots of the spline. A drag
+// is one entry from press to release, however many frames it takes. Undo
+// and redo re-apply one entry and go through the same incremental solve as
+// the edit itself, so their cost follows the edit, not the spline. Entries
+// live in a ring capped by memory, past the cap the oldest ones are dropped.
+
+const size_t SPLINE_JOURNAL_DEFAULT_BYTES = 1 << 20;
+
+typedef enum {
+    SPLINE_EDIT_MOVE_POINT,
+    SPLINE_EDIT_INSERT_POINT,
+    SPLINE_EDIT_BEGIN_TANGENT,
+    SPLINE_EDIT_END_TANGENT,
+} SplineEditKind;
+
+typedef struct {
+    SplineEditKind kind;
+    int index;              // for point edits
+    Vector2 from;           // both ends are kept so undo and redo restore values exactly
+    Vector2 to;
+} SplineEdit;
+
+typedef struct {
+    int capacity;           // max entries, from the memory cap
+    int entries_capacity;   // allocated, grows up to capacity
+    int head;               // ring index of the oldest entry
+    int n_entries;
+    int cursor;             // entries before it are done, from it on are undone
+    bool open;              // pending is still being dragged
+    SplineEdit pending;     // kept out of the ring until it turns out to change something
+    SplineEdit* entries;
+} SplineJournal;
+
+SplineJournal spline_journal_create(size_t max_bytes) {
+    SplineJournal journal = {0};
+    size_t capacity = max_bytes / sizeof(SplineEdit);
+    journal.capacity = (capacity > INT_MAX) ? INT_MAX : (capacity < 1) ? 1 : (int) capacity;
+    return journal;
+}
+
+void spline_journal_free(SplineJournal* journal) {
+    free(journal->entries);
+    journal->entries = NULL;
+    journal->entries_capacity = 0;
+    journal->head = 0;
+    journal->n_entries = 0;
+    journal->cursor = 0;
+    journal->open = false;
+}
+
+SplineEdit* spline_journal_get(SplineJournal* journal, int i) {
+    return &journal->entries[((int64_t) journal->head + i) % journal->entries_capacity];
+}
+
+// a new edit drops whatever was undone, past the cap it drops the oldest entry
+void spline_journal_push(SplineJournal* journal, SplineEdit edit) {
+    journal->n_entries = journal->cursor;
+
+    if (journal->n_entries == journal->entries_capacity) {
+        if (journal->entries_capacity < journal->capacity) {
+            // the ring only wraps once it is at full capacity, so head is 0 while it grows
+            // capacity can be up to INT_MAX, do not double past it
+            int new_capacity = (journal->entries_capacity == 0) ? 64
+                : (journal->entries_capacity > journal->capacity / 2) ? journal->capacity
+                : 2 * journal->entries_capacity;
+            if (new_capacity > journal->capacity) new_capacity = journal->capacity;
+            journal->entries_capacity = new_capacity;
+            journal->entries = realloc(journal->entries, new_capacity * sizeof(SplineEdit));
+        }
+        else {
+            journal->head = (journal->head + 1) % journal->entries_capacity;
+            journal->n_entries--;
+            journal->cursor--;
+        }
+    }
+
+    journal->n_entries++;
+    journal->cursor++;
+    *spline_journal_get(journal, journal->n_entries - 1) = edit;
+}
+
+// an open edit (a drag) only enters the journal when it is closed
+void spline_journal_record(SplineJournal* journal, SplineEdit edit, bool open) {
+    if (open) {
+        journal->pending = edit;
+        journal->open = true;
+    }
+    else {
+        spline_journal_push(journal, edit);
+    }
+}
+
+// coalesces a drag into its entry
+void spline_journal_update(SplineJournal* journal, Vector2 to) {
+    if (journal->open) {
+        journal->pending.to = to;
+    }
+}
+
+void spline_journal_close(SplineJournal* journal) {
+    if (!journal->open) {
+        return;
+    }
+    journal->open = false;
+
+    // a click without a drag changed nothing, the redo entries and the oldest entry stay
+    if (!Vector2Equals(journal->pending.from, journal->pending.to)) {
+        spline_journal_push(journal, journal->pending);
+    }
+}
+
+bool spline_journal_undo(SplineJournal* journal, SplineEdit* edit) {
+    if (journal->open || journal->cursor == 0) {
+        return false;
+    }
+    journal->cursor--;
+    *edit = *spline_journal_get(journal, journal->cursor);
+    return true;
+}
+
+bool spline_journal_redo(SplineJournal* journal, SplineEdit* edit) {
+    if (journal->open || journal->cursor == journal->n_entries) {
+        return false;
+    }
+    *edit = *spline_journal_get(journal, journal->cursor);
+    journal->cursor++;
+    return true;
+}
+
+// returns the point whose neighbourhood has to be re-solved
+int spline_apply_edit(Spline* spline, SplineEdit edit, bool undo) {
+    Vector2 value = undo ? edit.from : edit.to;
+
+    switch (edit.kind) {
+        case SPLINE_EDIT_MOVE_POINT:
+            spline->points[edit.index].coord = value;
+            return edit.index;
+        case SPLINE_EDIT_INSERT_POINT:
+            // points are only ever inserted at the back
+            if (undo) {
+                spline->n_points--;
+                return spline->n_points - 1;
+            }
+            spline_push_back_point(spline, (ControlPoint) {.coord = value});
+            return edit.index;
+        case SPLINE_EDIT_BEGIN_TANGENT:
+            spline->begin_tangent_normalized = value;
+            return 0;
+        case SPLINE_EDIT_END_TANGENT:
+            spline->end_tangent_normalized = value;
+            return spline->n_points - 1;
+    }
+    return -1;
+}
+
+typedef struct {
+    Graph2DCanvas graph2d_canvas;
+    Spline spline;
+    SplineStyle spline_style;
+    CurveTessellation curve_tessellation;
+    SplineSolver* solver;
+    SplineJournal journal;
+    CurvePublisher* publisher;  // NULL when the curves are not published
+    // -- Stream Mode --
+    SplineStream* stream;   // NULL when the spline is edited by hand
+    StreamSource* stream_source;
+    double stream_rate;     // points per second
+    double stream_rate_time;
+    unsigned long long stream_rate_pushed;
+    // -- System Data --
+    Vector2 relative_mouse;
+    bool mouse_in_canvas;
+    int64_t input_time_ns;
+    bool spline_updated;
+    int updated_point_lo;
+    int updated_point_hi;
+    int point_hold;
+    bool begin_tangent_hold;
+    bool end_tangent_hold;
+} SplineEntity;
+
+SplineEntity spline_entity_create_default(int id) {
+
+    Rectangle graph2d_canvas_rect = {
+        .x = 100,
+        .y = 100,
+        .width = 800,
+        .height = 400,
+    };
+    Graph2DCanvas graph2d_canvas = graph2d_canvas_create_default(id, graph2d_canvas_rect);
+
+    Spline spline = new_init_spline();
+
+    SplineStyle spline_style = {
+        .arrow_head_radius = 20,
+        .arrow_length = 100,
+        .control_point_radius = 10,
+        .control_point_idle_color = RED,
+        .control_point_hold_color = MAGENTA,
+        .curve_color = BLUE,
+    };
+
+    return (SplineEntity) {
+        .graph2d_canvas = graph2d_canvas,
+        .spline = spline,
+        .spline_style = spline_style,
+        .curve_tessellation = {0},
+        .solver = spline_solver_create(&spline),
+        .journal = spline_journal_create(SPLINE_JOURNAL_DEFAULT_BYTES),
+        .publisher = NULL,
+        // -- Stream Mode --
+        .stream = NULL,
+        .stream_source = NULL,
+        .stream_rate = 0,
+        .stream_rate_time = 0,
+        .stream_rate_pushed = 0,
+        // -- System Data --
+        .relative_mouse = {0, 0},
+        .mouse_in_canvas = false,
+        .input_time_ns = 0,
+        .spline_updated = false,
+        .updated_point_lo = 0,
+        .updated_point_hi = -1,
+        .point_hold = -1,
+        .begin_tangent_hold = false,
+        .end_tangent_hold = false,
+    };
+}
+
+void spline_entity_set_stream(SplineEntity* spline_entity, StreamSource* source, int window) {
+    spline_entity->stream = spline_stream_create(window);
+    spline_entity->stream_source = source;
+}
+
+void spline_entity_set_publisher(SplineEntity* spline_entity, CurvePublisher* publisher) {
+    spline_entity->publisher = publisher;
+    spline_solver_set_publisher(spline_entity->solver, publisher);
+}
+
+void spline_entity_destroy(SplineEntity* spline_entity) {
+    if (spline_entity->stream != NULL) {
+        stream_source_close(spline_entity->stream_source);
+        spline_stream_destroy(spline_entity->stream);
+    }
+    spline_solver_destroy(spline_entity->solver);
+    if (spline_entity->publisher != NULL) {
+        curve_publisher_destroy(spline_entity->publisher);
+    }
+    spline_journal_free(&spline_entity->journal);
+    spline_free(&spline_entity->spline);
+    free(spline_entity->curve_tessellation.vertices);
+}
+
+void spline_entity_mark_updated(SplineEntity* spline_entity, int point) {
+    if (!spline_entity->spline_updated) {
+        spline_entity->updated_point_lo = point;
+        spline_entity->updated_point_hi = point;
+    }
+    if (point < spline_entity->updated_point_lo) spline_entity->updated_point_lo = point;
+    if (point > spline_entity->updated_point_hi) spline_entity->updated_point_hi = point;
+    spline_entity->spline_updated = true;
+}
+
+// ctrl+z undo, ctrl+y or ctrl+shift+z redo, on the canvas under the mouse
+void spline_entity_process_history_input(SplineEntity* spline_entity, const InputFrame* input) {
+    Spline* spline = &spline_entity->spline;
+    SplineJournal* journal = &spline_entity->journal;
+
+    bool holding = spline_entity->point_hold != -1
+        || spline_entity->begin_tangent_hold
+        || spline_entity->end_tangent_hold;
+    bool control = input_down(input, INPUT_KEY_CONTROL);
+    bool shift = input_down(input, INPUT_KEY_SHIFT);
+    if (!spline_entity->mouse_in_canvas || holding || !control) {
+        return;
+    }
+
+    bool z = input_pressed(input, INPUT_KEY_Z);
+    bool y = input_pressed(input, INPUT_KEY_Y);
+    bool undo = z && !shift;
+    bool redo = y || (z && shift);
+
+    SplineEdit edit;
+    if (undo && spline_journal_undo(journal, &edit)) {
+        spline_entity_mark_updated(spline_entity, spline_apply_edit(spline, edit, true));
+    }
+    else if (redo && spline_journal_redo(journal, &edit)) {
+        spline_entity_mark_updated(spline_entity, spline_apply_edit(spline, edit, false));
+    }
+}
+
+void spline_entity_set_input(SplineEntity* spline_entity, const InputFrame* input) {
+    UICanvas* canvas = &spline_entity->graph2d_canvas.canvas;
+    Vector2 mouse_screen = input->mouse;
+    Vector2 mouse = GetScreenToWorld2D(mouse_screen, spline_entity->graph2d_canvas.camera);
+    spline_entity->relative_mouse = axis2d_shift_into(canvas->axis, mouse);
+    spline_entity->mouse_in_canvas = CheckCollisionPointRec(mouse_screen, canvas->rect);
+    spline_entity->input_time_ns = input->time_ns;
+}
+
+void spline_entity_process_input(SplineEntity* spline_entity, const InputFrame* input) {
+    Graph2DCanvas* graph2d_canvas = &spline_entity->graph2d_canvas;
+    Spline* spline = &spline_entity->spline;
+    SplineStyle* spline_style = &spline_entity->spline_style;
+    int* set_point_hold = &spline_entity->point_hold;
+    bool* set_begin_tangent_hold = &spline_entity->begin_tangent_hold;
+    bool* set_end_tangent_hold = &spline_entity->end_tangent_hold;
+
+    SplineJournal* journal = &spline_entity->journal;
+
+    if (spline_entity->stream != NULL) {
+        // points come from the stream, only the view can be moved
+        return;
+    }
+
+    spline_entity_process_history_input(spline_entity, input);
+
+    Vector2 relative_mouse = spline_entity->relative_mouse;
+
+    float x_axis_len = graph2d_canvas->axis_len.x;
+    float y_axis_len = graph2d_canvas->axis_len.y;
+    float local_spline_style_arrow_length = graph2d_canvas_scale_into(graph2d_canvas, spline_style->arrow_length);
+    float local_spline_style_arrow_head_radius = graph2d_canvas_scale_into(graph2d_canvas, spline_style->arrow_head_radius);
+    float local_spline_style_control_point_radius = graph2d_canvas_scale_into(graph2d_canvas, spline_style->control_point_radius);
+
+    // other canvases may map the same mouse position into this graph under their own camera
+    if (input_pressed(input, INPUT_MOUSE_LEFT) && spline_entity->mouse_in_canvas) {
+        printf("mouse: %0.2f, %0.2f\n", relative_mouse.x, relative_mouse.y);
+
+        if (spline->n_points > 0) {
+            Vector2 begin_neg_tangent_head = Vector2Add(
+                spline->points[0].coord,
+                Vector2Scale(spline->begin_tangent_normalized, local_spline_style_arrow_length)
+            );
+            if (Vector2DistanceSqr(begin_neg_tangent_head, relative_mouse) <= f_sq(local_spline_style_arrow_head_radius)) {
+                *set_begin_tangent_hold = true;
+                spline_journal_record(journal, (SplineEdit) {
+                    .kind = SPLINE_EDIT_BEGIN_TANGENT,
+                    .index = 0,
+                    .from = spline->begin_tangent_normalized,
+                    .to = spline->begin_tangent_normalized,
+                }, true);
+                goto END_HOLD_CHECK;
+            }
+
+            if (spline->n_points > 1) {
+                Vector2 end_neg_tangent_head = Vector2Add(
+                    spline->points[spline->n_points - 1].coord,
+                    Vector2Scale(spline->end_tangent_normalized, local_spline_style_arrow_length)
+                );
+                if (Vector2DistanceSqr(end_neg_tangent_head, relative_mouse) <= f_sq(local_spline_style_arrow_head_radius)) {
+                    *set_end_tangent_hold = true;
+                    spline_journal_record(journal, (SplineEdit) {
+                        .kind = SPLINE_EDIT_END_TANGENT,
+                        .index = spline->n_points - 1,
+                        .from = spline->end_tangent_normalized,
+                        .to = spline->end_tangent_normalized,
+                    }, true);
+                    goto END_HOLD_CHECK;
+                }
+            }
+        }
+
+        // only the points within a radius in x can be under the mouse
+        int i_first = spline_lower_bound(spline, relative_mouse.x - local_spline_style_control_point_radius);
+        for (int i = i_first; i < spline->n_points; i++) {
+            Vector2 coord = spline->points[i].coord;
+            if (coord.x > relative_mouse.x + local_spline_style_control_point_radius) {
+                break;
+            }
+            if (Vector2DistanceSqr(coord, relative_mouse) <= f_sq(local_spline_style_control_point_radius)) {
+                *set_point_hold = i;
+                spline_journal_record(journal, (SplineEdit) {
+                    .kind = SPLINE_EDIT_MOVE_POINT,
+                    .index = i,
+                    .from = coord,
+                    .to = coord,
+                }, true);
+                goto END_HOLD_CHECK;
+            }
+        }
+
+        float x_low_limit = (spline->n_points == 0) ? 0 : spline->points[spline->n_points - 1].coord.x;
+        float x_high_limit = x_axis_len;
+        float limit_margin = local_spline_style_control_point_radius;
+        Vector2 low_limit = {
+            .x = x_low_limit + limit_margin,
+            .y = limit_margin,
+        };
+        Vector2 high_limit = {
+            .x = x_high_limit - limit_margin,
+            .y = y_axis_len - limit_margin,
+        };
+
+        printf("low_limit: %0.2f, %0.2f\n", low_limit.x, low_limit.y);
+        printf("high_limit: %0.2f, %0.2f\n", high_limit.x, high_limit.y);
+
+        if (low_limit.x <= relative_mouse.x && relative_mouse.x <= high_limit.x
             && low_limit.y <= relative_mouse.y && relative_mouse.y <= high_limit.y
         ) {
-            *set_spline_updated = true;
             ControlPoint point = {0};
             point.coord = relative_mouse;
             spline_push_back_point(spline, point);
+            spline_entity_mark_updated(spline_entity, spline->n_points - 1);
+            spline_journal_record(journal, (SplineEdit) {
+                .kind = SPLINE_EDIT_INSERT_POINT,
+                .index = spline->n_points - 1,
+                .from = point.coord,
+                .to = point.coord,
+            }, false);
         }
 
         END_HOLD_CHECK:
     }
-    else if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
+    else if (input_released(input, INPUT_MOUSE_LEFT)) {
         *set_point_hold = -1;
         *set_begin_tangent_hold = false;
         *set_end_tangent_hold = false;
+        spline_journal_close(journal);
+    }
+}
+
+void spline_entity_update_stream(SplineEntity* spline_entity) {
+    Graph2DCanvas* graph2d_canvas = &spline_entity->graph2d_canvas;
+    SplineStream* stream = spline_entity->stream;
+    Camera2D* camera = &graph2d_canvas->camera;
+
+    Axis2D axis = graph2d_canvas->canvas.axis;
+    Rectangle rect = graph2d_canvas->canvas.rect;
+
+    stream_source_drain(spline_entity->stream_source, stream);
+
+    // stored x moved left, move the camera with them so the view stays on the same data
+    if (stream->rebased_dx != 0) {
+        camera->target.x -= axis.orientation.x * axis2d_scale_out(axis, stream->rebased_dx);
+        stream->rebased_dx = 0;
+    }
+
+    // follow the newest point unless the view is being dragged
+    if (!graph2d_canvas->view_drag && stream->view.n_points > 0) {
+        Vector2 newest = axis2d_shift_out(axis, stream->view.points[stream->view.n_points - 1].coord);
+        camera->offset.x = rect.x + STREAM_FOLLOW_AT * rect.width;
+        camera->target.x = newest.x;
+    }
+
+    double time = GetTime();
+    if (time - spline_entity->stream_rate_time >= 1.0) {
+        spline_entity->stream_rate = (stream->n_pushed - spline_entity->stream_rate_pushed) / (time - spline_entity->stream_rate_time);
+        spline_entity->stream_rate_time = time;
+        spline_entity->stream_rate_pushed = stream->n_pushed;
     }
 }
 
@@ -658,28 +3198,34 @@ void spline_entity_update(SplineEntity* spline_entity) {
     Graph2DCanvas* graph2d_canvas = &spline_entity->graph2d_canvas;
     Spline* spline = &spline_entity->spline;
     SplineStyle* spline_style = &spline_entity->spline_style;
-    bool* set_spline_updated = &spline_entity->spline_updated;
+    SplineSolver* solver = spline_entity->solver;
+
+    if (spline_entity->stream != NULL) {
+        spline_entity_update_stream(spline_entity);
+        return;
+    }
 
     Vector2 relative_mouse = spline_entity->relative_mouse;
     int point_hold = spline_entity->point_hold;
     bool begin_tangent_hold = spline_entity->begin_tangent_hold;
     bool end_tangent_hold = spline_entity->end_tangent_hold;
 
-    Axis2D axis = graph2d_canvas->canvas.axis;
     float x_axis_len = graph2d_canvas->axis_len.x;
     float y_axis_len = graph2d_canvas->axis_len.y;
-    float local_spline_style_control_point_radius = axis2d_scale_into(axis, spline_style->control_point_radius);
+    float local_spline_style_control_point_radius = graph2d_canvas_scale_into(graph2d_canvas, spline_style->control_point_radius);
 
     if (begin_tangent_hold) {
-        *set_spline_updated = true;
+        spline_entity_mark_updated(spline_entity, 0);
         spline->begin_tangent_normalized = Vector2Normalize(Vector2Subtract(relative_mouse, spline->points[0].coord));
+        spline_journal_update(&spline_entity->journal, spline->begin_tangent_normalized);
     }
     else if (end_tangent_hold) {
-        *set_spline_updated = true;
+        spline_entity_mark_updated(spline_entity, spline->n_points - 1);
         spline->end_tangent_normalized = Vector2Normalize(Vector2Subtract(relative_mouse, spline->points[spline->n_points - 1].coord));
+        spline_journal_update(&spline_entity->journal, spline->end_tangent_normalized);
     }
     else if (point_hold != -1) { // spline->n_points > 0
-        *set_spline_updated = true;
+        spline_entity_mark_updated(spline_entity, point_hold);
         spline->points[point_hold].coord = relative_mouse;
 
         float x_low_limit, x_high_limit;
@@ -707,11 +3253,29 @@ void spline_entity_update(SplineEntity* spline_entity) {
         };
         spline->points[point_hold].coord.x = Clamp(spline->points[point_hold].coord.x, low_limit.x, high_limit.x);
         spline->points[point_hold].coord.y = Clamp(spline->points[point_hold].coord.y, low_limit.y, high_limit.y);
+        spline_journal_update(&spline_entity->journal, spline->points[point_hold].coord);
+    }
+
+    // solved in the background, the curves drawn this frame are the newest ones the solver finished
+    if (spline_entity->spline_updated) {
+        spline_solver_post(solver, spline, spline_entity->updated_point_lo, spline_entity->updated_point_hi, spline_entity->input_time_ns);
+        spline_entity->spline_updated = false;
     }
+    spline_solver_acquire(solver);
+}
 
-    if (*set_spline_updated) {
-        spline_calculate_curves(spline);
-        *set_spline_updated = false;
+// the part of drawing that does not need a window, also run by headless replays
+void spline_entity_tessellate(SplineEntity* spline_entity, GraphView view) {
+    Axis2D axis = spline_entity->graph2d_canvas.canvas.axis;
+    CurveTessellation* curve_tessellation = &spline_entity->curve_tessellation;
+    SplineStream* stream = spline_entity->stream;
+
+    if (stream != NULL) {
+        spline_tessellate_curves_shifting(&stream->view, axis, view, stream->dirty_x, curve_tessellation);
+        stream->dirty_x = FLT_MAX;
+    }
+    else {
+        spline_tessellate_curves(spline_solver_get_curves(spline_entity->solver), axis, view, curve_tessellation);
     }
 }
 
@@ -719,10 +3283,238 @@ void spline_entity_draw(SplineEntity* spline_entity) {
     Graph2DCanvas* graph2d_canvas = &spline_entity->graph2d_canvas;
     Spline* spline = &spline_entity->spline;
     SplineStyle* spline_style = &spline_entity->spline_style;
+    CurveTessellation* curve_tessellation = &spline_entity->curve_tessellation;
+    SplineSolver* solver = spline_entity->solver;
     int point_hold = spline_entity->point_hold;
 
-    graph2d_canvas_draw(graph2d_canvas);
-    spline_draw_curves(spline, *spline_style, graph2d_canvas->canvas.axis, point_hold);
+    SplineStream* stream = spline_entity->stream;
+    Axis2D axis = graph2d_canvas->canvas.axis;
+    Rectangle rect = graph2d_canvas->canvas.rect;
+
+    GraphView view = graph2d_canvas_get_view(graph2d_canvas);
+    spline_entity_tessellate(spline_entity, view);
+
+    if (stream != NULL) {
+        graph2d_canvas_begin_draw(graph2d_canvas);
+            spline_draw_curves(curve_tessellation, *spline_style, view);
+        graph2d_canvas_end_draw();
+
+        const char* stream_str = TextFormat(
+            "stream: %d points, %.0f points/s",
+            stream->view.n_points,
+            spline_entity->stream_rate
+        );
+        DrawText(stream_str, rect.x + 5, rect.y + 5, 10, DARKGRAY);
+        return;
+    }
+
+    graph2d_canvas_begin_draw(graph2d_canvas);
+        spline_draw_curves(curve_tessellation, *spline_style, view);
+        spline_draw_control_points(spline, *spline_style, axis, view, point_hold);
+    graph2d_canvas_end_draw();
+
+    const char* lag_str = TextFormat(
+        "solver lag: %d frames (mean %.1f, max %d)",
+        solver->lag_frames,
+        spline_solver_get_lag_frames_mean(solver),
+        solver->lag_frames_max
+    );
+    DrawText(lag_str, rect.x + 5, rect.y + 5, 10, DARKGRAY);
+
+    CurvePublisher* publisher = spline_entity->publisher;
+    if (publisher != NULL) {
+        const char* publish_str = TextFormat(
+            "%s: %.0f us to readers (max %.0f us)",
+            publisher->name,
+            atomic_load_explicit(&publisher->latency_ns, memory_order_relaxed) / 1000.0,
+            atomic_load_explicit(&publisher->latency_max_ns, memory_order_relaxed) / 1000.0
+        );
+        DrawText(publish_str, rect.x + 5, rect.y + 17, 10, DARKGRAY);
+    }
+}
+
+// input and update of a frame, shared by the editor loop and replays
+void spline_entities_process_input(SplineEntity* spline_entity_array, int spline_count, const InputFrame* input) {
+    for(int i = 0; i < spline_count; i++) {
+        graph2d_canvas_process_view_input(&spline_entity_array[i].graph2d_canvas, input);
+    }
+    for(int i = 0; i < spline_count; i++) {
+        spline_entity_set_input(&spline_entity_array[i], input);
+    }
+    for(int i = 0; i < spline_count; i++) {
+        spline_entity_process_input(&spline_entity_array[i], input);
+    }
+}
+
+void spline_entities_update(SplineEntity* spline_entity_array, int spline_count) {
+    for(int i = 0; i < spline_count; i++) {
+        spline_entity_update(&spline_entity_array[i]);
+    }
+}
+
+// -- Replay --
+// --replay LOG runs a recorded session headless and as fast as it goes,
+// through the same input, update and tessellation as the editor, then
+// reports what the frames cost and how long inputs took to show up as
+// solved curves. Solvers run on their threads as usual. Frame costs leave
+// out what only a window does: draw calls and the GPU.
+
+typedef struct {
+    int capacity;
+    int n_samples;
+    int64_t* samples;   // ns
+} TimingSamples;
+
+void timing_samples_push(TimingSamples* timing, int64_t sample) {
+    if (timing->n_samples == timing->capacity) {
+        timing->capacity = (timing->capacity == 0) ? 1024 : 2 * timing->capacity;
+        timing->samples = realloc(timing->samples, timing->capacity * sizeof(int64_t));
+    }
+    timing->samples[timing->n_samples++] = sample;
+}
+
+int timing_sample_compare(const void* a, const void* b) {
+    int64_t sa = *(const int64_t*) a;
+    int64_t sb = *(const int64_t*) b;
+    return (sa > sb) - (sa < sb);
+}
+
+void timing_samples_report(const char* name, TimingSamples* timing) {
+    int n = timing->n_samples;
+    if (n == 0) {
+        printf("%-16s no samples\n", name);
+        return;
+    }
+    qsort(timing->samples, n, sizeof(int64_t), timing_sample_compare);
+    double total = 0;
+    for (int i = 0; i < n; i++) {
+        total += timing->samples[i];
+    }
+    printf("%-16s n %8d  mean %9.1f  p50 %9.1f  p90 %9.1f  p99 %9.1f  max %9.1f us\n",
+        name, n, total / n / 1000.0,
+        timing->samples[n / 2] / 1000.0,
+        timing->samples[(int) (0.9 * (n - 1))] / 1000.0,
+        timing->samples[(int) (0.99 * (n - 1))] / 1000.0,
+        timing->samples[n - 1] / 1000.0
+    );
+}
+
+void timing_samples_free(TimingSamples* timing) {
+    free(timing->samples);
+    *timing = (TimingSamples) {0};
+}
+
+// the curves of a canvas changed since it was last looked at: one latency sample
+void replay_collect_latency(SplineEntity* spline_entity, unsigned long long* n_updates, TimingSamples* latency) {
+    SplineSolver* solver = spline_entity->solver;
+    if (solver->n_updates != *n_updates) {
+        *n_updates = solver->n_updates;
+        timing_samples_push(latency, solver->update_latency_ns);
+    }
+}
+
+void replay_run(InputLog* log, SplineEntity* spline_entity_array, int spline_count) {
+    if (log->header.screen_width != GLOBAL.SCREEN_WIDTH || log->header.screen_height != GLOBAL.SCREEN_HEIGHT) {
+        printf("Replay: recorded on a %ux%u screen, replaying on %ux%u, edits may land elsewhere\n",
+            log->header.screen_width, log->header.screen_height, GLOBAL.SCREEN_WIDTH, GLOBAL.SCREEN_HEIGHT);
+    }
+
+    TimingSamples input_cost = {0};
+    TimingSamples update_cost = {0};
+    TimingSamples tessellate_cost = {0};
+    TimingSamples frame_cost = {0};
+    TimingSamples latency = {0};
+    unsigned long long* n_updates = calloc(spline_count, sizeof(unsigned long long));
+
+    int64_t begin = time_now_ns();
+    InputFrame input;
+    while (input_log_read(log, &input)) {
+        int64_t input_begin = input.time_ns;
+        spline_entities_process_input(spline_entity_array, spline_count, &input);
+        int64_t update_begin = time_now_ns();
+        spline_entities_update(spline_entity_array, spline_count);
+        int64_t tessellate_begin = time_now_ns();
+        for (int i = 0; i < spline_count; i++) {
+            spline_entity_tessellate(&spline_entity_array[i], graph2d_canvas_get_view(&spline_entity_array[i].graph2d_canvas));
+        }
+        int64_t end = time_now_ns();
+
+        timing_samples_push(&input_cost, update_begin - input_begin);
+        timing_samples_push(&update_cost, tessellate_begin - update_begin);
+        timing_samples_push(&tessellate_cost, end - tessellate_begin);
+        timing_samples_push(&frame_cost, end - input_begin);
+        for (int i = 0; i < spline_count; i++) {
+            replay_collect_latency(&spline_entity_array[i], &n_updates[i], &latency);
+        }
+    }
+    int64_t elapsed = time_now_ns() - begin;
+
+    // the last inputs may still be solving, wait for them so their latency is counted too,
+    // swapping without acquiring so the waiting does not count as frames of lag
+    for (int i = 0; i < spline_count; i++) {
+        SplineSolver* solver = spline_entity_array[i].solver;
+        while (solver->shown_generation != solver->generation) {
+            sched_yield();
+            spline_solver_swap(solver);
+        }
+        replay_collect_latency(&spline_entity_array[i], &n_updates[i], &latency);
+    }
+
+    printf("Replay: %llu frames in %.3f s, %.0f frames/s\n", log->n_frames, elapsed / 1e9, log->n_frames / (elapsed / 1e9));
+    for (int i = 0; i < spline_count; i++) {
+        SplineSolver* solver = spline_entity_array[i].solver;
+        printf("canvas %d: %d points, solver lag mean %.1f max %d frames\n",
+            i, spline_entity_array[i].spline.n_points, spline_solver_get_lag_frames_mean(solver), solver->lag_frames_max);
+    }
+    timing_samples_report("input", &input_cost);
+    timing_samples_report("update", &update_cost);
+    timing_samples_report("tessellate", &tessellate_cost);
+    timing_samples_report("frame", &frame_cost);
+    timing_samples_report("input to curves", &latency);
+
+    timing_samples_free(&input_cost);
+    timing_samples_free(&update_cost);
+    timing_samples_free(&tessellate_cost);
+    timing_samples_free(&frame_cost);
+    timing_samples_free(&latency);
+    free(n_updates);
+}
+
+// --script-drag-storm LOG FRAMES: writes a log that puts points across the
+// canvas at rect and then drags them up and down one after another, every
+// frame a new position: a reproducible worst case for --replay
+void input_log_script_drag_storm(InputLog* log, Rectangle rect, int n_frames) {
+    float y[16];
+    const int n_points = sizeof(y) / sizeof(y[0]);
+    const int drag_frames = 60;
+    float x_begin = rect.x + 0.2 * rect.width;
+    float x_step = 0.6 * rect.width / (n_points - 1);
+    float y_mid = rect.y + 0.5 * rect.height;
+    float y_amplitude = 0.3 * rect.height;
+
+    InputFrame input = {0};
+    for (int k = 0; k < n_points; k++) {
+        // the first point sits lower, out of the way of its tangent's arrow head
+        y[k] = (k == 0) ? y_mid + 0.5 * y_amplitude : y_mid;
+        input = (InputFrame) {.mouse = {x_begin + k * x_step, y[k]}, .down = INPUT_MOUSE_LEFT, .pressed = INPUT_MOUSE_LEFT};
+        input_log_write(log, &input);
+        input = (InputFrame) {.mouse = input.mouse, .released = INPUT_MOUSE_LEFT};
+        input_log_write(log, &input);
+    }
+
+    for (int drag = 0; log->n_frames < (unsigned long long) n_frames; drag++) {
+        int k = drag % n_points;
+        input = (InputFrame) {.mouse = {x_begin + k * x_step, y[k]}, .down = INPUT_MOUSE_LEFT, .pressed = INPUT_MOUSE_LEFT};
+        input_log_write(log, &input);
+        for (int f = 1; f <= drag_frames; f++) {
+            input.pressed = 0;
+            input.mouse.y = y[k] + y_amplitude * sinf(f * 2 * PI / drag_frames * (1 + k % 3));
+            input_log_write(log, &input);
+        }
+        y[k] = input.mouse.y;
+        input = (InputFrame) {.mouse = input.mouse, .released = INPUT_MOUSE_LEFT};
+        input_log_write(log, &input);
+    }
 }
 
 void draw_point_on_canvas(Axis2D axis, Vector2 pos, float radius) {
@@ -731,20 +3523,27 @@ void draw_point_on_canvas(Axis2D axis, Vector2 pos, float radius) {
     DrawCircle(pos.x, pos.y, radius, BLUE);
 }
 
-int main() {
+int main(int argc, char** argv) {
 
-    InitWindow(GLOBAL.SCREEN_WIDTH, GLOBAL.SCREEN_HEIGHT, "CurveMaker");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench-fixed") == 0 && i + 1 < argc) {
+            fixed_spline_benchmark(atoi(argv[i + 1]));
+            return 0;
+        }
+        if (strcmp(argv[i], "--bench-parametric") == 0 && i + 1 < argc) {
+            parametric_spline_benchmark(atoi(argv[i + 1]));
+            return 0;
+        }
+#ifndef _WIN32
+        if (strcmp(argv[i], "--read-shared") == 0 && i + 1 < argc) {
+            return shared_curves_read(argv[i + 1]);
+        }
+#endif
+    }
 
     // const int SCREEN_MARGIN_X = GLOBAL.SCREEN_WIDTH / 8;
     // const int SCREEN_MARGIN_Y = GLOBAL.SCREEN_HEIGHT / 8;
 
-    Camera2D camera = {0};
-    camera.zoom = 1.0;
-    // camera.offset = (Vector2) {
-    //     .x = SCREEN_MARGIN_X,
-    //     .y = GLOBAL.SCREEN_HEIGHT - SCREEN_MARGIN_Y,
-    // };
-
     int spline_count = 4;
     SplineEntity spline_entity_array[4] = {0};
 
@@ -792,33 +3591,115 @@ int main() {
             .height = canvas_height,
         }
     );
+
+    // --undo-memory BYTES: memory cap of each canvas' undo journal
+    // --window N: rolling window of the streams after it
+    // --stream SOURCE: plots a live stream into the next canvas, see stream_source_open
+    // --publish PREFIX: publishes each canvas' curves to shared memory PREFIX-<canvas>, see shared_curves.h
+    // --record LOG: records the session's input
+    // --replay LOG: replays recorded input headless, no window, and reports timings
+    // --script-drag-storm LOG FRAMES: writes a log of FRAMES frames of dragging on the first canvas
+    int stream_window = STREAM_WINDOW_DEFAULT;
+    int stream_canvas = 0;
+    InputLog* record_log = NULL;
+    const char* replay_path = NULL;
+    const char* script_path = NULL;
+    int script_frames = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--undo-memory") == 0 && i + 1 < argc) {
+            const char* text = argv[++i];
+            char* end;
+            errno = 0;
+            unsigned long long undo_memory = strtoull(text, &end, 10);
+            // strtoull takes a minus sign and wraps, a byte count has none
+            if (end == text || *end != '\0' || errno == ERANGE || strchr(text, '-') != NULL || undo_memory > SIZE_MAX) {
+                printf("Undo: --undo-memory wants a byte count, got '%s', keeping the default\n", text);
+                continue;
+            }
+            for (int j = 0; j < spline_count; j++) {
+                spline_journal_free(&spline_entity_array[j].journal);
+                spline_entity_array[j].journal = spline_journal_create(undo_memory);
+            }
+        }
+        else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            stream_window = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc && stream_canvas < spline_count) {
+            StreamSource* source = stream_source_open(argv[++i]);
+            if (source != NULL) {
+                spline_entity_set_stream(&spline_entity_array[stream_canvas++], source, stream_window);
+            }
+        }
+        else if (strcmp(argv[i], "--publish") == 0 && i + 1 < argc) {
+            const char* prefix = argv[++i];
+            for (int j = 0; j < spline_count; j++) {
+                if (spline_entity_array[j].publisher != NULL) {
+                    continue;
+                }
+                CurvePublisher* publisher = curve_publisher_create(TextFormat("%s-%d", prefix, j), PUBLISH_CAPACITY_DEFAULT);
+                if (publisher != NULL) {
+                    spline_entity_set_publisher(&spline_entity_array[j], publisher);
+                }
+            }
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc && record_log == NULL) {
+            record_log = input_log_create(argv[++i], GLOBAL.SCREEN_WIDTH, GLOBAL.SCREEN_HEIGHT);
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--script-drag-storm") == 0 && i + 2 < argc) {
+            script_path = argv[++i];
+            script_frames = atoi(argv[++i]);
+        }
+    }
+
+    // headless modes, done before there is a window
+    if (script_path != NULL || replay_path != NULL) {
+        InputLog* log = NULL;
+        if (script_path != NULL && (log = input_log_create(script_path, GLOBAL.SCREEN_WIDTH, GLOBAL.SCREEN_HEIGHT)) != NULL) {
+            input_log_script_drag_storm(log, spline_entity_array[0].graph2d_canvas.canvas.rect, script_frames);
+            printf("Script: %llu frames written to %s\n", log->n_frames, script_path);
+            input_log_close(log);
+        }
+        else if (replay_path != NULL && (log = input_log_open(replay_path)) != NULL) {
+            replay_run(log, spline_entity_array, spline_count);
+            input_log_close(log);
+        }
+
+        if (record_log != NULL) {
+            input_log_close(record_log);
+        }
+        for(int i = 0; i < spline_count; i++) {
+            spline_entity_destroy(&spline_entity_array[i]);
+        }
+        return (log == NULL) ? 1 : 0;
+    }
+
+    InitWindow(GLOBAL.SCREEN_WIDTH, GLOBAL.SCREEN_HEIGHT, "CurveMaker");
     
 
+    InputFrame input = {0};
     while (!WindowShouldClose()) {
         
         // INPUT
-        for(int i = 0; i < spline_count; i++) {
-            spline_entity_set_input(&spline_entity_array[i], camera);
-        }
-        for(int i = 0; i < spline_count; i++) {
-            spline_entity_process_input(&spline_entity_array[i]);
+        input = input_frame_poll(&input);
+        if (record_log != NULL) {
+            input_log_write(record_log, &input);
         }
+        spline_entities_process_input(spline_entity_array, spline_count, &input);
 
         // UPDATE
-        for(int i = 0; i < spline_count; i++) {
-            spline_entity_update(&spline_entity_array[i]);
-        }
+        spline_entities_update(spline_entity_array, spline_count);
         
         // DRAW
         BeginDrawing();
             ClearBackground(BEIGE);
-            BeginMode2D(camera);
-
-                for(int i = 0; i < spline_count; i++) {
-                    spline_entity_draw(&spline_entity_array[i]);
-                }
 
-            EndMode2D();
+            // every canvas draws through its own camera
+            for(int i = 0; i < spline_count; i++) {
+                spline_entity_draw(&spline_entity_array[i]);
+            }
 
             // draw_point_on_canvas(spline_entity.graph2d_canvas.canvas.axis, (Vector2) {50, 50}, 10);
 
@@ -827,6 +3708,14 @@ int main() {
 
         EndDrawing();
     }
+
+    if (record_log != NULL) {
+        printf("Record: %llu frames\n", record_log->n_frames);
+        input_log_close(record_log);
+    }
+    for(int i = 0; i < spline_count; i++) {
+        spline_entity_destroy(&spline_entity_array[i]);
+    }
     
     CloseWindow();
 
@@ -0,0 +1,95 @@
+#ifndef SHARED_CURVES_H
+#define SHARED_CURVES_H
+
+// Layout of the shared-memory segment curvemaker publishes solved curves
+// into (see --publish), for readers in other processes.
+//
+// The segment is a header followed by two slots. The writer only ever writes
+// the slot that is not active, then flips `active` to it. Each slot carries
+// a sequence number that is odd while the writer is in it, so a reader that
+// was too slow and got lapped can tell. Reading is in place, no copies, no
+// syscalls and no locks:
+//
+//     uint64_t sequence;
+//     const SharedCurvesSlot* slot;
+//     do {
+//         slot = shared_curves_begin_read(header, &sequence);
+//         ... read slot->n_points, shared_curves_slot_points(slot)[i] ...
+//     } while (!shared_curves_end_read(slot, sequence));
+//
+// There is one writer per segment: curvemaker creates the segment exclusively
+// and refuses a name that already exists.
+//
+// Timestamps are CLOCK_MONOTONIC nanoseconds, comparable across processes
+// on the same machine.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define SHARED_CURVES_MAGIC 0x56525543 // "CURV"
+#define SHARED_CURVES_VERSION 1
+
+// one joint and the curve that starts at it:
+// y = a*u^3 + b*u^2 + c*u + d, u = x - joint x, up to the next joint
+typedef struct {
+    float x, y;
+    float a, b, c, d;
+} SharedCurvePoint;
+
+typedef struct {
+    _Atomic uint64_t sequence;  // odd while being written
+    uint64_t generation;        // solver generation, grows with every published edit
+    int64_t input_time_ns;      // when the oldest edit in this slot was made
+    int64_t publish_time_ns;    // when this slot was made active
+    uint32_t n_points;          // points in this slot, at most capacity
+    uint32_t n_points_total;    // points in the spline, more than n_points if it did not fit
+    float begin_tangent[2];
+    float end_tangent[2];
+    uint8_t reserved[8];
+} SharedCurvesSlot;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;          // points per slot
+    _Atomic uint32_t active;    // slot readers should use
+    uint8_t reserved[48];
+} SharedCurvesHeader;
+
+static inline size_t shared_curves_slot_size(uint32_t capacity) {
+    return sizeof(SharedCurvesSlot) + capacity * sizeof(SharedCurvePoint);
+}
+
+static inline size_t shared_curves_size(uint32_t capacity) {
+    return sizeof(SharedCurvesHeader) + 2 * shared_curves_slot_size(capacity);
+}
+
+static inline SharedCurvesSlot* shared_curves_slot(const SharedCurvesHeader* header, uint32_t i) {
+    return (SharedCurvesSlot*) ((char*) header + sizeof(SharedCurvesHeader) + i * shared_curves_slot_size(header->capacity));
+}
+
+static inline SharedCurvePoint* shared_curves_slot_points(const SharedCurvesSlot* slot) {
+    return (SharedCurvePoint*) ((char*) slot + sizeof(SharedCurvesSlot));
+}
+
+static inline const SharedCurvesSlot* shared_curves_begin_read(const SharedCurvesHeader* header, uint64_t* sequence) {
+    while (true) {
+        uint32_t active = atomic_load_explicit(&((SharedCurvesHeader*) header)->active, memory_order_acquire);
+        SharedCurvesSlot* slot = shared_curves_slot(header, active);
+        uint64_t s = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if ((s & 1) == 0) {
+            *sequence = s;
+            return slot;
+        }
+    }
+}
+
+// false if the writer got into the slot while it was being read, read it again
+static inline bool shared_curves_end_read(const SharedCurvesSlot* slot, uint64_t sequence) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&((SharedCurvesSlot*) slot)->sequence, memory_order_relaxed) == sequence;
+}
+
+#endif